@@ -25,25 +25,112 @@
 // RTOS Defines and Kernel Variables
 //-----------------------------------------------------------------------------
 
+// queue of tasks blocked on a kernel object, linked through the tcb
+typedef struct _waitQueue
+{
+    uint8_t head;               // next task to wake
+    uint8_t tail;               // last task to wake
+    uint8_t order;              // WAIT_FIFO or WAIT_PRIORITY
+} waitQueue;
+
+// handles: pool slot in the low byte and the slot's generation in the high byte
+// the generation changes each time a slot is reused, so handles to a deleted object fail
+// generations start at 1, so no valid handle is 0 (INVALID_HANDLE)
+#define HANDLE_INDEX(h)         ((h) & 0xFF)
+#define HANDLE_GENERATION(h)    ((h) >> 8)
+#define MAKE_HANDLE(i, g)       ((uint16_t)(((g) << 8) | (i)))
+#define NO_OBJECT               0xFF
+#define POOL_INDEX(pool, h)     poolIndex(pool, sizeof((pool)[0]), sizeof(pool) / sizeof((pool)[0]), h)
+#define POOL_ALLOC(pool)        poolAlloc(pool, sizeof((pool)[0]), sizeof(pool) / sizeof((pool)[0]))
+
+// pool slot header, the first member of every kernel object
+typedef struct _objectSlot
+{
+    bool used;                  // allocated from the pool
+    uint8_t generation;         // generation of the handle to the current object
+} objectSlot;
+
 // mutex
 typedef struct _mutex
 {
+    objectSlot slot;
     bool lock;
-    uint8_t queueSize;
-    uint8_t processQueue[MAX_MUTEX_QUEUE_SIZE];
+    waitQueue queue;
     uint8_t lockedBy;
+    uint8_t ceiling;            // priority taken by the owner under the ceiling protocol
+    volatile uint32_t *word;    // owner word of a fast mutex (0 = kernel mutex)
 } mutex;
+#define NO_CEILING 0xFF
 mutex mutexes[MAX_MUTEXES];
 
 // semaphore
 typedef struct _semaphore
 {
+    objectSlot slot;
     uint8_t count;
-    uint8_t queueSize;
-    uint8_t processQueue[MAX_SEMAPHORE_QUEUE_SIZE];
+    waitQueue queue;
 } semaphore;
 semaphore semaphores[MAX_SEMAPHORES];
 
+// event group
+typedef struct _eventGroup
+{
+    objectSlot slot;
+    uint32_t flags;
+    waitQueue queue;
+} eventGroup;
+eventGroup eventGroups[MAX_EVENT_GROUPS];
+
+// message queue
+typedef struct _msgQueue
+{
+    objectSlot slot;
+    uint8_t *storage;           // depth messages, supplied by the creator
+    uint16_t itemSize;          // bytes per message (0 = pointer queue)
+    uint8_t depth;              // messages the storage holds
+    uint8_t count;              // messages queued
+    uint8_t head;               // slot of the oldest message
+    waitQueue senders;          // tasks waiting for room
+    waitQueue receivers;        // tasks waiting for a message
+} msgQueue;
+msgQueue msgQueues[MAX_QUEUES];
+
+// condition variable
+typedef struct _condition
+{
+    objectSlot slot;
+    waitQueue queue;
+} condition;
+condition conditions[MAX_CONDITIONS];
+
+// reader-writer lock
+typedef struct _rwlock
+{
+    objectSlot slot;
+    uint8_t readers;            // tasks holding the lock for reading
+    uint8_t writer;             // task holding the lock for writing (NO_TASK if none)
+    waitQueue readQueue;        // tasks waiting to read
+    waitQueue writeQueue;       // tasks waiting to write
+} rwlock;
+rwlock rwlocks[MAX_RWLOCKS];
+
+// ring buffer, kernel side (the producer works from these, not from the consumer's copies)
+typedef struct _ringState
+{
+    objectSlot slot;
+    ringBuffer *buffer;         // heap block shared with the consumer
+    uint32_t *items;
+    uint32_t mask;
+    semaphoreHandle data;
+    threadHandle consumer;      // thread given access to the heap block
+} ringState;
+ringState rings[MAX_RINGS];
+
+
+// fast mutex owner word: owner thread handle, and a flag set while tasks are blocked on it
+#define FAST_OWNER_M            0x0000FFFF
+#define FAST_WAITERS            0x80000000
+
 // task states
 #define STATE_INVALID           0 // no task
 #define STATE_STOPPED           1 // stopped, all memory freed
@@ -51,40 +138,146 @@ semaphore semaphores[MAX_SEMAPHORES];
 #define STATE_DELAYED           3 // has run, but now awaiting timer
 #define STATE_BLOCKED_MUTEX     4 // has run, but now blocked by mutex
 #define STATE_BLOCKED_SEMAPHORE 5 // has run, but now blocked by semaphore
+#define STATE_BLOCKED_EVENT     6 // has run, but now blocked by event group
+#define STATE_BLOCKED_QUEUE     7 // has run, but now blocked sending to or receiving from a message queue
+#define STATE_BLOCKED_CALL      8 // has run, but now waiting for a server to take its call
+#define STATE_BLOCKED_REPLY     9 // has run, but now waiting for a server to reply to its call
+#define STATE_BLOCKED_RECEIVE  10 // has run, but now waiting (as a server) for a call
+#define STATE_BLOCKED_CONDITION 11 // has run, but now waiting on a condition variable
+#define STATE_BLOCKED_RWLOCK   12 // has run, but now blocked by reader-writer lock
 
 // task
 uint8_t taskCurrent = 0;          // index of last dispatched task
+threadHandle runningThread = 0;   // handle of the last dispatched task (read by tasks through getPid())
 uint8_t taskCount = 0;            // total number of valid tasks
 
 // control
-bool priorityScheduler = true;    // priority (true) or round-robin (false)
+uint8_t schedPolicy = SCHED_PRIO; // SCHED_PRIO, SCHED_RR or SCHED_EDF
 bool priorityInheritance = false; // priority inheritance for mutexes
 bool preemption = false;          // preemption (true) or cooperative (false)
+bool ticklessIdle = false;        // stop the tick while only the idle task is ready
 
 // tcb
 #define NUM_PRIORITIES   16
 struct _tcb
 {
     uint8_t state;                 // see STATE_ values above
-    void *pid;                     // used to uniquely identify thread (add of task fn)
+    void *pid;                     // address of the task fn
+    uint8_t generation;            // generation of the thread's handle (see MAKE_HANDLE)
     void* mallocated;              // the base address of the region allocated by malloc
     uint32_t size;                 // the allocation size
     void *spInit;                  // original top of stack
     void *sp;                      // current stack pointer
     uint8_t priority;              // 0=highest
     uint8_t currentPriority;       // 0=highest (needed for pi)
-    uint32_t ticks;                // ticks until sleep complete
+    uint8_t next;                  // next task in the ready list of currentPriority
+    uint8_t prev;                  // previous task in the ready list of currentPriority
+    uint32_t period;               // ticks between job releases (0 = not periodic)
+    uint32_t relDeadline;          // ticks from a job release to its deadline
+    uint32_t release;              // tick count at which the current job was released
+    uint32_t deadline;             // tick count by which the current job must complete
+    uint32_t deadlineMisses;       // jobs that completed after their deadline
+    uint32_t wcet;                 // declared worst-case execution time in ticks (0 = undeclared)
+    uint32_t responseTime;         // worst-case response time from the last admission test
+    uint8_t edfNext;               // next task in the edf ready list
+    uint8_t edfPrev;               // previous task in the edf ready list
+    uint32_t wakeTick;             // tick count at which the sleep completes
+    uint8_t timerNext;             // next task in the sleep timer list
+    uint8_t timerPrev;             // previous task in the sleep timer list
+    bool timeout;                  // blocked on a kernel object and also on the timer list
+    uint8_t eventGroup;            // index of the event group that is blocking the thread
+    uint32_t eventMask;            // flags the thread is waiting for
+    uint8_t eventOptions;          // EVENT_WAIT_ALL and EVENT_CLEAR bits of the wait
+    uint8_t msgQueue;              // index of the message queue that is blocking the thread
+    bool msgSend;                  // blocked sending (true) or receiving (false)
+    void *msgBuffer;               // message being sent, or where the received message goes
+    uint8_t ipcServer;             // index of the server the thread has called
+    waitQueue callers;             // clients waiting for this thread to take their call
+    uint8_t condition;             // index of the condition variable the thread waits on (mutex holds the mutex to relock)
+    uint8_t rwlock;                // index of the reader-writer lock that is blocking the thread
+    bool rwWrite;                  // blocked waiting to write (true) or to read (false)
+    uint8_t rwReading;             // bit i set while the thread holds reader-writer lock i for reading
     uint64_t srd;                  // MPU subregion disable bits
+    uint64_t sharedSrd;            // subregion bits of shared buffers (ring buffers), kept across a restart
     char name[16];                 // name of task used in ps command
     uint8_t mutex;                 // index of the mutex in use or blocking the thread
     uint8_t semaphore;             // index of the semaphore that is blocking the thread
+    uint8_t waitNext;              // next task in the wait queue of the blocking mutex or semaphore
+    uint8_t waitPrev;              // previous task in the wait queue of the blocking mutex or semaphore
     uint32_t timeElapsed[2];       // ping-pong buffers to keep track of the time elapsed running a task
+    uint32_t blockStart;           // cycle count when the task last blocked on a mutex
+    uint32_t maxBlocked;           // longest time spent blocked on a mutex (cycles)
+    bool woken;                    // made ready and not yet dispatched
+    uint32_t wakeCycles;           // cycle count when the task was last made ready
+    uint32_t wakeLatency;          // cycles from the last wakeup to running
+    uint32_t maxWakeLatency;       // longest time from a wakeup to running (cycles)
 
 } tcb[MAX_TASKS];
 
 bool recordTime = true;
 uint16_t pingPong = 0;
 
+// ready queues (one circular list per priority, plus a bitmap of the non-empty lists)
+#define NO_TASK 0xFF
+#define PRIORITY_BIT(p) (0x80000000 >> (p))
+uint8_t readyHead[NUM_PRIORITIES];  // next task to run at each priority
+uint32_t readyPriorities = 0;       // PRIORITY_BIT(p) set when priority p has a ready task
+uint8_t edfHead = NO_TASK;          // ready periodic task with the earliest deadline
+
+// round-robin time slices
+#define DEFAULT_TIME_SLICE 1
+uint8_t timeSlice[NUM_PRIORITIES];  // ticks a task runs before an equal priority task gets a turn
+uint8_t sliceLeft = 0;              // ticks left in the running task's slice
+
+// sleep timer list (delayed tasks sorted by absolute wake tick)
+uint32_t tickCount = 0;             // ticks since the kernel started
+uint8_t timerHead = NO_TASK;        // delayed task with the earliest wake tick
+
+// true once tick count now has reached tick (wrap safe)
+#define TICK_REACHED(now, tick) ((int32_t)((now) - (tick)) >= 0)
+
+// tickless idle (wide timer 1 replaces systick while only the idle task is ready)
+#define IDLE_PRIORITY       (NUM_PRIORITIES - 1)
+#define CYCLES_PER_TICK     40000
+#define MAX_TICKLESS_TICKS  100000      // longest idle period with no sleeper to wake (100 s)
+bool ticklessActive = false;            // systick is stopped and wide timer 1 is running
+uint32_t ticklessLoad = 0;              // cycles programmed into wide timer 1
+uint32_t ticklessResidual = 0;          // cycles that were left in the interrupted tick
+
+// count leading zeros (single CLZ instruction on the M4F)
+#if defined(__TI_ARM__)
+#define clz(x) _norm(x)
+#else
+#define clz(x) __builtin_clz(x)
+#endif
+
+// DWT cycle counter used to benchmark kernel paths
+#define DWT_CTRL_R              (*((volatile uint32_t *)0xE0001000))
+#define DWT_CYCCNT_R            (*((volatile uint32_t *)0xE0001004))
+#define DWT_CTRL_CYCCNTENA      0x00000001
+#define NVIC_DBG_INT_TRCENA     0x01000000
+
+// benchmarks (cycles spent in kernel paths, shown by the bench command)
+#define BENCH_SCHED     0
+#define BENCH_LOCK      1
+#define BENCH_UNLOCK    2
+#define BENCH_SWITCH    3
+#define BENCH_HANDOFF   4               // blocking service call entry to the next task running
+#define BENCH_COUNT     5
+struct _bench
+{
+    uint32_t last;
+    uint32_t max;
+} bench[BENCH_COUNT];
+const char* benchName[BENCH_COUNT] = {"sched", "lock", "unlock", "switch", "handoff"};
+
+// set when a service call switches tasks directly, with the cycle count on entry
+bool svcHandoff = false;
+uint32_t handoffStart = 0;
+
+// task to switch to without running the scheduler (client-server handoff)
+uint8_t directTask = NO_TASK;
+
 // PS
 struct _ps
 {
@@ -111,652 +304,3163 @@ struct _ps
 #define PREEMPT     0x0D
 #define SCHED       0x0E
 #define PIDOF       0x0F
+#define BENCH       0x10
+#define TICKLESS    0x11
+#define PERIOD      0x12
+#define RTA         0x13
+#define SLICE       0x14
+#define PI          0x15
+#define LOCK_TIMEOUT 0x16
+#define WAIT_TIMEOUT 0x17
+#define SLEEP_UNTIL 0x18
+#define TICKS       0x19
+#define SET_EVENTS  0x1A
+#define CLEAR_EVENTS 0x1B
+#define WAIT_EVENTS 0x1C
+#define SEND        0x1D
+#define RECEIVE     0x1E
+#define CALL        0x1F
+#define REPLY_WAIT  0x20
+#define FAST_LOCK   0x21
+#define FAST_UNLOCK 0x22
+#define COND_WAIT   0x23
+#define COND_SIGNAL 0x24
+#define COND_BROADCAST 0x25
+#define READ_LOCK   0x26
+#define READ_UNLOCK 0x27
+#define WRITE_LOCK  0x28
+#define WRITE_UNLOCK 0x29
+#define CREATE_MUTEX 0x2A
+#define DELETE_MUTEX 0x2B
+#define INIT_FAST   0x2C
+#define CREATE_SEMAPHORE 0x2D
+#define DELETE_SEMAPHORE 0x2E
+#define MUTEX_ORDER 0x2F
+#define SEMAPHORE_ORDER 0x30
+#define CREATE_EVENTS 0x31
+#define DELETE_EVENTS 0x32
+#define CREATE_QUEUE 0x33
+#define DELETE_QUEUE 0x34
+#define CREATE_COND 0x35
+#define DELETE_COND 0x36
+#define CREATE_RWLOCK 0x37
+#define DELETE_RWLOCK 0x38
+#define CREATE_RING 0x39
+#define DELETE_FAST 0x3A
+#define DELETE_RING 0x3B
+#define SVC_COUNT   0x3C
+#define SVC_NUMBER_M 0xFF               // R12 bits holding the service call number
+
+// service call handler
+typedef void (*_svc)(uint32_t *frame);
 
 //-----------------------------------------------------------------------------
 // Subroutines
 //-----------------------------------------------------------------------------
 
-bool initMutex(uint8_t mutex)
+// bump the generation of a pool slot so handles to its previous object stop matching
+uint8_t nextGeneration(uint8_t generation)
 {
-    bool ok = (mutex < MAX_MUTEXES);
-    if (ok)
-    {
-        mutexes[mutex].lock = false;
-        mutexes[mutex].lockedBy = 0;
-    }
-    return ok;
+    generation++;
+    if(generation == 0)
+        generation = 1;
+    return generation;
 }
 
-bool initSemaphore(uint8_t semaphore, uint8_t count)
+// find the slot of a handle in a pool of count objects of stride bytes
+// returns NO_OBJECT if the handle is invalid or its object was deleted
+uint8_t poolIndex(void *pool, uint16_t stride, uint8_t count, uint16_t handle)
 {
-    bool ok = (semaphore < MAX_SEMAPHORES);
+    uint8_t i = HANDLE_INDEX(handle);
+    objectSlot *slot;
+    if(i >= count)
+        return NO_OBJECT;
+    slot = (objectSlot*) ((uint8_t*) pool + i * stride);
+    if(slot->used && slot->generation == HANDLE_GENERATION(handle))
+        return i;
+    return NO_OBJECT;
+}
+
+// claim a free slot in a pool of count objects of stride bytes for a new object
+// returns the slot, or NO_OBJECT if the pool is exhausted
+uint8_t poolAlloc(void *pool, uint16_t stride, uint8_t count)
+{
+    uint8_t i;
+    objectSlot *slot;
+    for(i = 0; i < count; i++)
     {
-        semaphores[semaphore].count = count;
+        slot = (objectSlot*) ((uint8_t*) pool + i * stride);
+        if(!slot->used)
+        {
+            slot->used = true;
+            slot->generation = nextGeneration(slot->generation);
+            return i;
+        }
     }
-    return ok;
+    return NO_OBJECT;
 }
 
-// REQUIRED: initialize systick for 1ms system timer
-void initRtos(void)
+// find the pool slot of a mutex handle, NO_OBJECT if the handle is invalid or was deleted
+uint8_t mutexIndex(mutexHandle mutex)
+{
+    return POOL_INDEX(mutexes, mutex);
+}
+
+// find the pool slot of a semaphore handle, NO_OBJECT if the handle is invalid or was deleted
+uint8_t semaphoreIndex(semaphoreHandle semaphore)
+{
+    return POOL_INDEX(semaphores, semaphore);
+}
+
+// find the tcb record of a thread handle, NO_OBJECT if the handle is invalid or stale
+uint8_t threadIndex(threadHandle thread)
+{
+    uint8_t i = HANDLE_INDEX(thread);
+    if(i < MAX_TASKS && tcb[i].state != STATE_INVALID && tcb[i].generation == HANDLE_GENERATION(thread))
+        return i;
+    return NO_OBJECT;
+}
+
+// create a mutex from the pool, with a ceiling priority or NO_CEILING
+// returns its handle, or INVALID_HANDLE if the pool is exhausted
+mutexHandle mutexCreate(uint8_t ceiling)
 {
     uint8_t i;
-    // no tasks running
-    taskCount = 0;
-    // clear out tcb records
-    for (i = 0; i < MAX_TASKS; i++)
+    if(ceiling >= NUM_PRIORITIES && ceiling != NO_CEILING)
+        return INVALID_HANDLE;
+    i = POOL_ALLOC(mutexes);
+    if(i == NO_OBJECT)
+        return INVALID_HANDLE;
+    mutexes[i].lock = false;
+    mutexes[i].lockedBy = 0;
+    mutexes[i].queue.head = NO_TASK;
+    mutexes[i].queue.tail = NO_TASK;
+    mutexes[i].queue.order = WAIT_FIFO;
+    mutexes[i].ceiling = ceiling;
+    mutexes[i].word = 0;
+    return MAKE_HANDLE(i, mutexes[i].slot.generation);
+}
+
+// return a mutex to the pool
+// fails if the mutex is locked (and so may have waiters) or backs a fast mutex
+bool mutexDelete(mutexHandle mutex)
+{
+    uint8_t i = mutexIndex(mutex);
+    bool ok = (i != NO_OBJECT) && !mutexes[i].lock && (mutexes[i].word == 0);
+    if (ok)
     {
-        tcb[i].state = STATE_INVALID;
-        tcb[i].pid = 0;
-        tcb[i].srd = 0;
+        mutexes[i].slot.used = false;
     }
+    return ok;
 }
 
-// REQUIRED: Implement prioritization to NUM_PRIORITIES
-uint8_t rtosScheduler(void)
+// set up a fast mutex, with a kernel mutex from the pool for its contended path
+// the fast mutex must live in memory the tasks that use it can access
+bool fastMutexInit(fastMutex *fast)
 {
     bool ok;
-    uint8_t i = 0;
-    static uint8_t task = 0xFF;
-    ok = false;
-    if(priorityScheduler)
+    fast->owner = 0;
+    fast->mutex = mutexCreate(NO_CEILING);
+    ok = (fast->mutex != INVALID_HANDLE);
+    if (ok)
     {
-        uint8_t highestPriority = NUM_PRIORITIES;
-        while (i < MAX_TASKS)
-        {
-            if(tcb[i].state == STATE_READY)
-            {
-                if(tcb[i].priority < highestPriority)
-                {
-                    highestPriority = tcb[i].priority;
-                }
-            }
-            i++;
-        }
-        while(!ok)
-        {
-            task++;
-            if (task >= MAX_TASKS)
-                task = 0;
-            ok = (tcb[task].state == STATE_READY && tcb[task].priority == highestPriority);
-        }
-        return task;
+        mutexes[HANDLE_INDEX(fast->mutex)].word = &fast->owner;
     }
-    else if(!priorityScheduler)
+    return ok;
+}
+
+// return the kernel mutex of a fast mutex to the pool
+// fails if the fast mutex is locked
+bool fastMutexDelete(fastMutex *fast)
+{
+    uint8_t i = mutexIndex(fast->mutex);
+    bool ok = (i != NO_OBJECT) && (mutexes[i].word == &fast->owner) && (fast->owner == 0);
+    if (ok)
     {
-        while (!ok)
-        {
-            task++;
-            if (task >= MAX_TASKS)
-                task = 0;
-            ok = (tcb[task].state == STATE_READY);
-        }
-        return task;
+        mutexes[i].word = 0;
+        mutexes[i].slot.used = false;
+        fast->mutex = INVALID_HANDLE;
     }
-    else return 0;
+    return ok;
 }
 
-// REQUIRED: modify this function to start the operating system
-// by calling scheduler, set srd bits, setting PSP, ASP bit, call fn with fn add in R0
-// fn set TMPL bit, and PC <= fn
-void startRtos(void)
+// find the pool slot of a condition variable handle, NO_OBJECT if the handle is invalid or was deleted
+uint8_t conditionIndex(condHandle cv)
 {
-    setPsp(0x20008000);
-    setAsp();
-    switchToUnprivilegedMode();
-    __asm(" SVC #0x00");
+    return POOL_INDEX(conditions, cv);
 }
 
-// Create Thread:
-// add task if room in task list
-// store the thread name
-// allocate stack space and store top of stack in sp and spInit
-// set the srd bits based on the memory allocation
-// initialize the created stack to make it appear the thread has run before
-bool createThread(_fn fn, const char name[], uint8_t priority, uint32_t stackBytes)
+// create a condition variable from the pool
+// returns its handle, or INVALID_HANDLE if the pool is exhausted
+condHandle conditionCreate(void)
 {
-    bool ok = false;
-    uint8_t i = 0;
-    bool found = false;
-    if (taskCount < MAX_TASKS)
-    {
-        // make sure fn not already in list (prevent reentrancy)
-        while (!found && (i < MAX_TASKS))
-        {
-            found = (tcb[i++].pid ==  fn);
-        }
-        if (!found)
-        {
-            // find first available tcb record
-            i = 0;
-            while (tcb[i].state != STATE_INVALID) {i++;}
-
-            // found an available record
-            void* baseAddr = mallocFromHeap(stackBytes);
-            tcb[i].mallocated = baseAddr;
-            tcb[i].size = stackBytes;
-            tcb[i].state = STATE_READY;
-            tcb[i].pid = fn;
-            tcb[i].sp = (void*)((uint32_t) baseAddr + stackBytes);
-            tcb[i].spInit = (void*)((uint32_t) baseAddr + stackBytes);
-            tcb[i].priority = priority;
-            tcb[i].ticks = 0;
-            addSramAccessWindow(&tcb[i].srd, (uint32_t*) baseAddr, stackBytes);
-            copyString(tcb[i].name, name);
-
-            // make the task seem like it ran before
-            uint32_t* p = tcb[i].sp;
-            *(--p) = (1 << 24);                                         // set the valid bit (thumb) in the EPSR (xPSR)
-            *(--p) = (uint32_t) fn;                                     // PC
-            *(--p) = 0xAAAABBBB;                                        // LR
-            *(--p) = 0X0000000C;                                        // R12
-            *(--p) = 0X00000003;                                        // R3
-            *(--p) = 0X00000002;                                        // R2
-            *(--p) = 0X00000001;                                        // R1
-            *(--p) = 0X00000000;                                        // R0
-            *(--p) = 0XAAAAAAAA;                                        // R11
-            *(--p) = 0XAAAAAAAA;                                        // R10
-            *(--p) = 0XAAAAAAAA;                                        // R9
-            *(--p) = 0XAAAAAAAA;                                        // R8
-            *(--p) = 0XAAAAAAAA;                                        // R7
-            *(--p) = 0XAAAAAAAA;                                        // R6
-            *(--p) = 0XAAAAAAAA;                                        // R5
-            *(--p) = 0XAAAAAAAA;                                        // R4
-            *(--p) = 0XFFFFFFFD;                                        // EXEC_RETURN
-
-            tcb[i].sp = --p;
+    uint8_t i = POOL_ALLOC(conditions);
+    if(i == NO_OBJECT)
+        return INVALID_HANDLE;
+    conditions[i].queue.head = NO_TASK;
+    conditions[i].queue.tail = NO_TASK;
+    conditions[i].queue.order = WAIT_PRIORITY;
+    return MAKE_HANDLE(i, conditions[i].slot.generation);
+}
 
-            // increment task count
-            taskCount++;
-            ok = true;
-        }
+// return a condition variable to the pool
+// fails if tasks are waiting on it
+bool conditionDelete(condHandle cv)
+{
+    uint8_t i = conditionIndex(cv);
+    bool ok = (i != NO_OBJECT) && (conditions[i].queue.head == NO_TASK);
+    if (ok)
+    {
+        conditions[i].slot.used = false;
     }
     return ok;
 }
 
-// REQUIRED: modify this function to restart a thread
-void restartThread(_fn fn)
+// find the pool slot of a reader-writer lock handle, NO_OBJECT if the handle is invalid or was deleted
+uint8_t rwlockIndex(rwlockHandle lock)
 {
-    __asm(" SVC #0x01");
+    return POOL_INDEX(rwlocks, lock);
 }
 
-// REQUIRED: modify this function to stop a thread
-// REQUIRED: remove any pending semaphore waiting, unlock any mutexes
-void stopThread(_fn fn)
+// create a reader-writer lock from the pool
+// returns its handle, or INVALID_HANDLE if the pool is exhausted
+rwlockHandle rwlockCreate(void)
 {
-    __asm(" SVC #0x0C");
+    uint8_t i = POOL_ALLOC(rwlocks);
+    if(i == NO_OBJECT)
+        return INVALID_HANDLE;
+    rwlocks[i].readers = 0;
+    rwlocks[i].writer = NO_TASK;
+    rwlocks[i].readQueue.head = NO_TASK;
+    rwlocks[i].readQueue.tail = NO_TASK;
+    rwlocks[i].readQueue.order = WAIT_PRIORITY;
+    rwlocks[i].writeQueue.head = NO_TASK;
+    rwlocks[i].writeQueue.tail = NO_TASK;
+    rwlocks[i].writeQueue.order = WAIT_PRIORITY;
+    return MAKE_HANDLE(i, rwlocks[i].slot.generation);
 }
 
-// REQUIRED: modify this function to set a thread priority
-void setThreadPriority(_fn fn, uint8_t priority)
+// return a reader-writer lock to the pool
+// fails if the lock is held
+bool rwlockDelete(rwlockHandle lock)
 {
-    __asm(" SVC #0x02");
+    uint8_t i = rwlockIndex(lock);
+    bool ok = (i != NO_OBJECT) && (rwlocks[i].readers == 0) && (rwlocks[i].writer == NO_TASK);
+    if (ok)
+    {
+        rwlocks[i].slot.used = false;
+    }
+    return ok;
 }
 
-// yield execution back to scheduler using pendsv
-void yield(void)
+// create a semaphore from the pool with an initial count
+// returns its handle, or INVALID_HANDLE if the pool is exhausted
+semaphoreHandle semaphoreCreate(uint8_t count)
 {
-    __asm(" SVC #0x03");
+    uint8_t i = POOL_ALLOC(semaphores);
+    if(i == NO_OBJECT)
+        return INVALID_HANDLE;
+    semaphores[i].count = count;
+    semaphores[i].queue.head = NO_TASK;
+    semaphores[i].queue.tail = NO_TASK;
+    semaphores[i].queue.order = WAIT_FIFO;
+    return MAKE_HANDLE(i, semaphores[i].slot.generation);
 }
 
-// execution yielded back to scheduler until time elapses using pendsv
-void sleep(uint32_t tick)
+// return a semaphore to the pool
+// fails if tasks are waiting on the semaphore
+bool semaphoreDelete(semaphoreHandle semaphore)
 {
-    __asm(" SVC #0x04");
+    uint8_t i = semaphoreIndex(semaphore);
+    bool ok = (i != NO_OBJECT) && (semaphores[i].queue.head == NO_TASK);
+    if (ok)
+    {
+        semaphores[i].slot.used = false;
+    }
+    return ok;
 }
 
-// Function to lock a mutex using pendsv
-void lock(int8_t mutex)
+// select the order in which the tasks blocked on a mutex are woken (WAIT_FIFO or WAIT_PRIORITY)
+bool mutexQueueOrder(mutexHandle mutex, uint8_t order)
 {
-    __asm(" SVC #0x05");
+    uint8_t i = mutexIndex(mutex);
+    bool ok = (i != NO_OBJECT) && (order <= WAIT_PRIORITY);
+    if (ok)
+    {
+        mutexes[i].queue.order = order;
+    }
+    return ok;
 }
 
-// function to unlock a mutex using pendsv
-void unlock(int8_t mutex)
+// select the order in which the tasks blocked on a semaphore are woken (WAIT_FIFO or WAIT_PRIORITY)
+bool semaphoreQueueOrder(semaphoreHandle semaphore, uint8_t order)
 {
-    __asm(" SVC #0x06");
+    uint8_t i = semaphoreIndex(semaphore);
+    bool ok = (i != NO_OBJECT) && (order <= WAIT_PRIORITY);
+    if (ok)
+    {
+        semaphores[i].queue.order = order;
+    }
+    return ok;
 }
 
-// function to wait a semaphore using pendsv
-void wait(int8_t semaphore)
+// find the pool slot of an event group handle, NO_OBJECT if the handle is invalid or was deleted
+uint8_t eventGroupIndex(eventHandle group)
 {
-    __asm(" SVC #0x07");
+    return POOL_INDEX(eventGroups, group);
 }
 
-// function to signal a semaphore is available using pendsv
-void post(int8_t semaphore)
+// create an event group from the pool with all flags clear
+// returns its handle, or INVALID_HANDLE if the pool is exhausted
+eventHandle eventGroupCreate(void)
 {
-    __asm(" SVC #0x08");
+    uint8_t i = POOL_ALLOC(eventGroups);
+    if(i == NO_OBJECT)
+        return INVALID_HANDLE;
+    eventGroups[i].flags = 0;
+    eventGroups[i].queue.head = NO_TASK;
+    eventGroups[i].queue.tail = NO_TASK;
+    eventGroups[i].queue.order = WAIT_FIFO;
+    return MAKE_HANDLE(i, eventGroups[i].slot.generation);
 }
 
-// Malloc From Heap SVC call
-uint32_t _malloc_from_heap(uint32_t stackBytes)
+// return an event group to the pool
+// fails if tasks are waiting on the group
+bool eventGroupDelete(eventHandle group)
 {
-    __asm(" SVC #0x09");
+    uint8_t i = eventGroupIndex(group);
+    bool ok = (i != NO_OBJECT) && (eventGroups[i].queue.head == NO_TASK);
+    if (ok)
+    {
+        eventGroups[i].slot.used = false;
+    }
+    return ok;
 }
 
-// Reboot Service Call
-void reboot()
+// find the pool slot of a message queue handle, NO_OBJECT if the handle is invalid or was deleted
+uint8_t msgQueueIndex(queueHandle queue)
 {
-    __asm(" SVC #0x0A");
+    return POOL_INDEX(msgQueues, queue);
 }
 
-// Process Status Service Call
-void ps(void)
+// create a message queue of depth messages of itemSize bytes
+// storage must hold depth * itemSize bytes and stay allocated while the queue exists
+// messages are copied in and out of the storage, or straight to a waiting receiver
+// returns its handle, or INVALID_HANDLE if the pool is exhausted
+queueHandle msgQueueCreate(void *storage, uint16_t itemSize, uint8_t depth)
 {
-    __asm(" SVC #0x0B");
+    uint8_t i;
+    if(storage == 0 || depth == 0)
+        return INVALID_HANDLE;
+    i = POOL_ALLOC(msgQueues);
+    if(i == NO_OBJECT)
+        return INVALID_HANDLE;
+    msgQueues[i].storage = (uint8_t*) storage;
+    msgQueues[i].itemSize = itemSize;
+    msgQueues[i].depth = depth;
+    msgQueues[i].count = 0;
+    msgQueues[i].head = 0;
+    msgQueues[i].senders.head = NO_TASK;
+    msgQueues[i].senders.tail = NO_TASK;
+    msgQueues[i].senders.order = WAIT_FIFO;
+    msgQueues[i].receivers.head = NO_TASK;
+    msgQueues[i].receivers.tail = NO_TASK;
+    msgQueues[i].receivers.order = WAIT_FIFO;
+    return MAKE_HANDLE(i, msgQueues[i].slot.generation);
 }
 
-// Kill Service Call
-void kill(uint32_t pid)
+// return a message queue to the pool
+// fails if tasks are waiting to send or receive
+bool msgQueueDelete(queueHandle queue)
 {
-    __asm(" SVC #0x0C");
+    uint8_t i = msgQueueIndex(queue);
+    bool ok = (i != NO_OBJECT) && (msgQueues[i].senders.head == NO_TASK) && (msgQueues[i].receivers.head == NO_TASK);
+    if (ok)
+    {
+        msgQueues[i].slot.used = false;
+    }
+    return ok;
 }
 
-// Preemption Service Call
-void preempt(bool toggle)
+// find the pool slot of the kernel descriptor of a ring buffer, NO_OBJECT if the ring
+// is invalid, was deleted or its handle was overwritten by the consumer
+uint8_t ringIndex(ringBuffer *ring)
 {
-    __asm(" SVC #0x0D");
+    uint8_t i = NO_OBJECT;
+    if(ring != 0)
+        i = POOL_INDEX(rings, ring->handle);
+    if(i != NO_OBJECT && rings[i].buffer != ring)
+        i = NO_OBJECT;
+    return i;
 }
 
-// Pidof shell command
-uint32_t pidof(char* name)
+// create a ring buffer of capacity items (a power of two) in a heap block that
+// the consumer thread is given access to through its sram access window
+// the window is kept in the shared mask too, so a restart of the consumer keeps it
+// returns 0 if the capacity is not a power of two or too large for the heap,
+// the thread does not exist or memory or the pools run out
+ringBuffer* ringCreate(uint32_t capacity, threadHandle consumer)
 {
-//    __asm(" SVC #0x0F");
-    uint8_t proc;
-    uint32_t pid = 0;
-    for(proc = 0; proc < MAX_TASKS; proc++)
+    ringBuffer *ring = 0;
+    uint32_t size;
+    uint8_t task = threadIndex(consumer);
+    uint8_t i;
+    if(capacity == 0 || (capacity & (capacity - 1)) != 0 || task == NO_OBJECT)
+        return 0;
+    if(capacity > (MAX_ALLOC_SIZE - sizeof(ringBuffer)) / sizeof(uint32_t))
+        return 0;
+    size = sizeof(ringBuffer) + capacity * sizeof(uint32_t);
+    i = POOL_ALLOC(rings);
+    if(i == NO_OBJECT)
+        return 0;
+    ring = mallocFromHeap(size);
+    if(ring == 0)
     {
-        if(stringCmp(tcb[proc].name, name) == 0)
-        {
-            pid = (uint32_t) tcb[proc].pid;
-            break;
-        }
+        rings[i].slot.used = false;
+        return 0;
     }
-    if(pid == 0)
+    rings[i].data = semaphoreCreate(0);
+    if(rings[i].data == INVALID_HANDLE)
+    {
+        freeToHeap(ring);
+        rings[i].slot.used = false;
         return 0;
-    return pid;
-}
-
-// Fetch PID
-uint32_t getPid()
-{
-    uint32_t id = (uint32_t) tcb[taskCurrent].pid;
-    return id;
+    }
+    rings[i].buffer = ring;
+    rings[i].items = (uint32_t*) (ring + 1);
+    rings[i].mask = capacity - 1;
+    rings[i].consumer = consumer;
+    ring->head = 0;
+    ring->tail = 0;
+    ring->mask = rings[i].mask;
+    ring->dropped = 0;
+    ring->waiting = false;
+    ring->handle = MAKE_HANDLE(i, rings[i].slot.generation);
+    ring->data = rings[i].data;
+    ring->items = rings[i].items;
+    addSramAccessWindow(&tcb[task].sharedSrd, (uint32_t*) ring, size);
+    tcb[task].srd |= tcb[task].sharedSrd;
+    if(task == taskCurrent)
+        applySramAccessMask(tcb[task].srd);
+    return ring;
 }
 
-// REQUIRED: modify this function to add support for the system timer
-// REQUIRED: in preemptive code, add code to request task switch
-void systickIsr(void)
+// free a ring buffer and take its window back from the consumer
+// fails if the ring is invalid or the consumer is waiting on it
+bool ringDelete(ringBuffer *ring)
 {
-    uint8_t i = 0;
-    for(i = 0; i < taskCount; i++)
+    uint8_t i = ringIndex(ring);
+    uint8_t task;
+    uint64_t window = 0;
+    if(i == NO_OBJECT || !semaphoreDelete(rings[i].data))
+        return false;
+    // the window is found from the heap block, so take it before the block is freed
+    addSramAccessWindow(&window, (uint32_t*) ring, sizeof(ringBuffer) + (rings[i].mask + 1) * sizeof(uint32_t));
+    freeToHeap(ring);
+    rings[i].slot.used = false;
+    task = threadIndex(rings[i].consumer);
+    if(task != NO_OBJECT)
     {
-        if(tcb[i].state == STATE_DELAYED)
-        {
-            tcb[i].ticks--;
-            if(tcb[i].ticks == 0)
-                tcb[i].state = STATE_READY;
-        }
+        window &= tcb[task].sharedSrd;
+        tcb[task].sharedSrd &= ~window;
+        tcb[task].srd &= ~window;
+        if(task == taskCurrent)
+            applySramAccessMask(tcb[task].srd);
     }
+    return true;
+}
 
-    pingPong++;
-
-    // change the active fill ping-pong buffer
-    if(pingPong == 1024)
-    {
-        if(recordTime)
-            recordTime = false;
-        else
-            recordTime = true;
-        pingPong = 0;
-    }
+// kernel objects are created and deleted through service calls, so the pools stay
+// consistent when threads do it while the rtos is running (not from interrupt handlers)
 
-    if(preemption)
-        NVIC_INT_CTRL_R |= NVIC_INT_CTRL_PEND_SV;   // enable pendsv
+// create a mutex from the pool
+// returns its handle, or INVALID_HANDLE if the pool is exhausted
+mutexHandle createMutex(void)
+{
+    return createMutexCeiling(NO_CEILING);
 }
 
-// REQUIRED: in coop and preemptive, modify this function to add support for task switching
-// REQUIRED: process UNRUN and READY tasks differently
-__attribute__((naked)) void pendSvIsr(void)
+// create a mutex that uses the immediate priority ceiling protocol
+// the ceiling must be the highest priority (lowest number) of any task that locks it
+mutexHandle createMutexCeiling(uint8_t ceiling)
 {
-    WTIMER0_CTL_R &= ~TIMER_CTL_TAEN;
-    tcb[taskCurrent].timeElapsed[recordTime] += WTIMER0_TAV_R;
+    __asm(" MOV R12, #0x2A");
+    __asm(" SVC #0x2A");
+}
 
-    if(((NVIC_FAULT_STAT_R & NVIC_FAULT_STAT_DERR)) || ((NVIC_FAULT_STAT_R & NVIC_FAULT_STAT_IERR)))
-    {
-        putsUart0("called from MPU\n\n");               // Print called from MPU and the clear the flags, exit.
-    }
+// return a mutex to the pool
+// fails if the mutex is locked (and so may have waiters)
+bool deleteMutex(mutexHandle mutex)
+{
+    __asm(" MOV R12, #0x2B");
+    __asm(" SVC #0x2B");
+}
 
-    // save the current task's context before switching to the next task
-    saveContext();
-    tcb[taskCurrent].sp = (void*) getPsp();
+// set up a fast mutex, with a kernel mutex from the pool for its contended path
+// the fast mutex must live in memory the tasks that use it can access
+bool initFastMutex(fastMutex *fast)
+{
+    __asm(" MOV R12, #0x2C");
+    __asm(" SVC #0x2C");
+}
 
-    // start the next task
-    taskCurrent = rtosScheduler();
-    uint64_t srdMask = tcb[taskCurrent].srd;
-    applySramAccessMask(srdMask);
-    uint32_t psp = (uint32_t) tcb[taskCurrent].sp;
-    setPsp(psp);
+// return the kernel mutex of a fast mutex to the pool
+// fails if the fast mutex is locked
+bool deleteFastMutex(fastMutex *fast)
+{
+    __asm(" MOV R12, #0x3A");
+    __asm(" SVC #0x3A");
+}
 
-    // START THE TIMER FOR PS CALCULATIONS
-    WTIMER0_TAV_R = 0;
-    WTIMER0_CTL_R |= TIMER_CTL_TAEN;
+// create a semaphore from the pool with an initial count
+// returns its handle, or INVALID_HANDLE if the pool is exhausted
+semaphoreHandle createSemaphore(uint8_t count)
+{
+    __asm(" MOV R12, #0x2D");
+    __asm(" SVC #0x2D");
+}
 
-    restoreTask();
+// return a semaphore to the pool
+// fails if tasks are waiting on the semaphore
+bool deleteSemaphore(semaphoreHandle semaphore)
+{
+    __asm(" MOV R12, #0x2E");
+    __asm(" SVC #0x2E");
 }
 
-// REQUIRED: modify this function to add support for the service call
-// REQUIRED: in preemptive code, add code to handle synchronization primitives
-void svCallIsr(void)
+// select the order in which the tasks blocked on a mutex are woken (WAIT_FIFO or WAIT_PRIORITY)
+// call before any task blocks on the mutex
+bool setMutexQueueOrder(mutexHandle mutex, uint8_t order)
 {
-    uint8_t svcNo = getSvcNo();
+    __asm(" MOV R12, #0x2F");
+    __asm(" SVC #0x2F");
+}
 
-    switch(svcNo)
-    {
-        case START:
-        {
-            uint64_t srdMask = 0;
-            uint32_t psp = 0;
+// select the order in which the tasks blocked on a semaphore are woken (WAIT_FIFO or WAIT_PRIORITY)
+// call before any task blocks on the semaphore
+bool setSemaphoreQueueOrder(semaphoreHandle semaphore, uint8_t order)
+{
+    __asm(" MOV R12, #0x30");
+    __asm(" SVC #0x30");
+}
 
-            taskCurrent = rtosScheduler();
-            srdMask = tcb[taskCurrent].srd;
-            applySramAccessMask(srdMask);
-            psp = (uint32_t) tcb[taskCurrent].sp;
-            setPsp(psp);
+// create an event group from the pool with all flags clear
+// returns its handle, or INVALID_HANDLE if the pool is exhausted
+eventHandle createEventGroup(void)
+{
+    __asm(" MOV R12, #0x31");
+    __asm(" SVC #0x31");
+}
 
-            restoreTask();
-            break;
-        }
-        case RESTART:
-        {
-            char *toStart = (char *) getR0();
-            uint8_t i;
-            for(i = 0; i < MAX_TASKS; i++)
-            {
-                if(stringCmp(toStart, tcb[i].name) == 0)
-                {
-                    uint32_t size = tcb[i].size;
-                    void *baseAddr = mallocFromHeap(size);
-                    uint64_t srdMask = createNoSramAccessMask();
-                    addSramAccessWindow(&srdMask, baseAddr, size);
-                    tcb[i].srd = srdMask;
-                    tcb[i].state = STATE_READY;
-
-                    //setting up stack
-                    tcb[i].sp = (void*)((uint32_t) baseAddr + size);
-                    tcb[i].spInit = baseAddr;
-
-                    // make the task seem like it ran before
-                    uint32_t* p = tcb[i].sp;
-                    *(--p) = (1 << 24);                                         // set the valid bit (thumb) in the EPSR (xPSR)
-                    *(--p) = (uint32_t) tcb[i].pid;                                     // PC
-                    *(--p) = 0xAAAABBBB;                                        // LR
-                    *(--p) = 0X0000000C;                                        // R12
-                    *(--p) = 0X00000003;                                        // R3
-                    *(--p) = 0X00000002;                                        // R2
-                    *(--p) = 0X00000001;                                        // R1
-                    *(--p) = 0X00000000;                                        // R0
-                    *(--p) = 0XAAAAAAAA;                                        // R11
-                    *(--p) = 0XAAAAAAAA;                                        // R10
-                    *(--p) = 0XAAAAAAAA;                                        // R9
-                    *(--p) = 0XAAAAAAAA;                                        // R8
-                    *(--p) = 0XAAAAAAAA;                                        // R7
-                    *(--p) = 0XAAAAAAAA;                                        // R6
-                    *(--p) = 0XAAAAAAAA;                                        // R5
-                    *(--p) = 0XAAAAAAAA;                                        // R4
-                    *(--p) = 0XFFFFFFFD;                                        // EXEC_RETURN
-
-                    tcb[i].sp = --p;
-
-                    putsUart0("Restarted\n");
-                    break;
-                }
-            }
-            NVIC_INT_CTRL_R |= NVIC_INT_CTRL_PEND_SV; //Initiating task switching
-            break;
-        }
-        case SET_PRIO:
-        {
-            uint8_t i;
-            void* pid = (void*) getR0();
-            for(i=0;i<MAX_TASKS;i++)
-            {
-                if(pid == tcb[i].pid)
-                {
-                    uint32_t *psp =(uint32_t *) getPsp();
-                    uint32_t priority = (uint32_t) *(psp+1);
-                    tcb[i].priority = priority;
-                    putsUart0("Set task Priority Successfully....\n\n");
-                    break;
-                }
-            }
-            NVIC_INT_CTRL_R |= NVIC_INT_CTRL_PEND_SV; //enable pendsv
-            break;
+// return an event group to the pool
+// fails if tasks are waiting on the group
+bool deleteEventGroup(eventHandle group)
+{
+    __asm(" MOV R12, #0x32");
+    __asm(" SVC #0x32");
+}
 
-        }
-        case YIELD:
-            NVIC_INT_CTRL_R |= NVIC_INT_CTRL_PEND_SV;  // Enable pendsv
-            break;
+// create a message queue of depth messages of itemSize bytes
+// storage must hold depth * itemSize bytes and stay allocated while the queue exists
+// returns its handle, or INVALID_HANDLE if the pool is exhausted
+queueHandle createQueue(void *storage, uint16_t itemSize, uint8_t depth)
+{
+    __asm(" MOV R12, #0x33");
+    __asm(" SVC #0x33");
+}
 
-        case SLEEP:
-            tcb[taskCurrent].ticks = getR0();
-            tcb[taskCurrent].state = STATE_DELAYED;
-            NVIC_INT_CTRL_R |= NVIC_INT_CTRL_PEND_SV;  // Enable pendsv
-            break;
+// create a message queue that passes buffer pointers instead of copying the buffers
+// sending a buffer hands its ownership to the receiver
+// storage must hold depth pointers
+queueHandle createPointerQueue(void **storage, uint8_t depth)
+{
+    return createQueue(storage, 0, depth);
+}
 
-        case LOCK:
-        {
-            uint8_t mutexCurrent = getR0();
-            if(!mutexes[mutexCurrent].lock)
-            {
-                tcb[taskCurrent].mutex = mutexCurrent;
-                mutexes[mutexCurrent].lock = true;
-                mutexes[mutexCurrent].lockedBy = taskCurrent;
-            }
-            else
-            {
-                tcb[taskCurrent].state = STATE_BLOCKED_MUTEX;
-                mutexes[mutexCurrent].processQueue[mutexes[mutexCurrent].queueSize++] = taskCurrent;
-                NVIC_INT_CTRL_R |= NVIC_INT_CTRL_PEND_SV;  // Enable pendsv
-            }
-            break;
-        }
+// return a message queue to the pool
+// fails if tasks are waiting to send or receive
+bool deleteQueue(queueHandle queue)
+{
+    __asm(" MOV R12, #0x34");
+    __asm(" SVC #0x34");
+}
+
+// create a condition variable from the pool
+// returns its handle, or INVALID_HANDLE if the pool is exhausted
+condHandle createCondition(void)
+{
+    __asm(" MOV R12, #0x35");
+    __asm(" SVC #0x35");
+}
+
+// return a condition variable to the pool
+// fails if tasks are waiting on it
+bool deleteCondition(condHandle cv)
+{
+    __asm(" MOV R12, #0x36");
+    __asm(" SVC #0x36");
+}
+
+// create a reader-writer lock from the pool
+// returns its handle, or INVALID_HANDLE if the pool is exhausted
+rwlockHandle createRwLock(void)
+{
+    __asm(" MOV R12, #0x37");
+    __asm(" SVC #0x37");
+}
+
+// return a reader-writer lock to the pool
+// fails if the lock is held
+bool deleteRwLock(rwlockHandle lock)
+{
+    __asm(" MOV R12, #0x38");
+    __asm(" SVC #0x38");
+}
+
+// create a ring buffer of capacity items (a power of two) that the consumer thread can access
+// returns 0 if the capacity is not a power of two, the thread does not exist or memory runs out
+ringBuffer* createRing(uint32_t capacity, threadHandle consumer)
+{
+    __asm(" MOV R12, #0x39");
+    __asm(" SVC #0x39");
+}
+
+// free a ring buffer and take the consumer thread's access to it back
+// fails if the ring is invalid or the consumer is waiting on it
+bool deleteRing(ringBuffer *ring)
+{
+    __asm(" MOV R12, #0x3B");
+    __asm(" SVC #0x3B");
+}
+
+// REQUIRED: initialize systick for 1ms system timer
+void initRtos(void)
+{
+    uint8_t i;
+    // no tasks running
+    taskCount = 0;
+    // clear out tcb records
+    for (i = 0; i < MAX_TASKS; i++)
+    {
+        tcb[i].state = STATE_INVALID;
+        tcb[i].pid = 0;
+        tcb[i].srd = 0;
+        tcb[i].sharedSrd = 0;
+    }
+    // empty ready queues
+    for (i = 0; i < NUM_PRIORITIES; i++)
+    {
+        readyHead[i] = NO_TASK;
+        timeSlice[i] = DEFAULT_TIME_SLICE;
+    }
+    readyPriorities = 0;
+    edfHead = NO_TASK;
+    // no reader-writer lock has a writer or waiters, not even an unused one
+    for (i = 0; i < MAX_RWLOCKS; i++)
+    {
+        rwlocks[i].writer = NO_TASK;
+        rwlocks[i].readQueue.head = NO_TASK;
+        rwlocks[i].readQueue.tail = NO_TASK;
+        rwlocks[i].writeQueue.head = NO_TASK;
+        rwlocks[i].writeQueue.tail = NO_TASK;
+    }
+    // no sleeping tasks
+    tickCount = 0;
+    timerHead = NO_TASK;
+    // enable the FPU with lazy stacking so only tasks that use it pay for saving it
+    NVIC_CPAC_R |= NVIC_CPAC_CP10_FULL | NVIC_CPAC_CP11_FULL;
+    NVIC_FPCC_R |= NVIC_FPCC_ASPEN | NVIC_FPCC_LSPEN;
+    __asm(" DSB");
+    __asm(" ISB");
+    // start the cycle counter for the benchmarks
+    NVIC_DBG_INT_R |= NVIC_DBG_INT_TRCENA;
+    DWT_CYCCNT_R = 0;
+    DWT_CTRL_R |= DWT_CTRL_CYCCNTENA;
+}
+
+// record the cycles elapsed since start against a benchmark
+void benchRecord(uint8_t id, uint32_t start)
+{
+    uint32_t cycles = DWT_CYCCNT_R - start;
+    bench[id].last = cycles;
+    if(cycles > bench[id].max)
+        bench[id].max = cycles;
+}
+
+// add a periodic task to the edf list, after any task with the same deadline
+void edfInsert(uint8_t task)
+{
+    uint8_t prev = NO_TASK;
+    uint8_t next = edfHead;
+    while(next != NO_TASK && TICK_REACHED(tcb[task].deadline, tcb[next].deadline))
+    {
+        prev = next;
+        next = tcb[next].edfNext;
+    }
+    tcb[task].edfPrev = prev;
+    tcb[task].edfNext = next;
+    if(prev == NO_TASK)
+        edfHead = task;
+    else
+        tcb[prev].edfNext = task;
+    if(next != NO_TASK)
+        tcb[next].edfPrev = task;
+}
+
+// remove a periodic task from the edf list
+void edfRemove(uint8_t task)
+{
+    uint8_t prev = tcb[task].edfPrev;
+    uint8_t next = tcb[task].edfNext;
+    if(prev == NO_TASK)
+        edfHead = next;
+    else
+        tcb[prev].edfNext = next;
+    if(next != NO_TASK)
+        tcb[next].edfPrev = prev;
+}
+
+// add a task to the tail of the ready list of its current priority
+void readyInsert(uint8_t task)
+{
+    uint8_t prio = tcb[task].currentPriority;
+    uint8_t head = readyHead[prio];
+    if(head == NO_TASK)
+    {
+        tcb[task].next = task;
+        tcb[task].prev = task;
+        readyHead[prio] = task;
+        readyPriorities |= PRIORITY_BIT(prio);
+    }
+    else
+    {
+        uint8_t tail = tcb[head].prev;
+        tcb[task].next = head;
+        tcb[task].prev = tail;
+        tcb[tail].next = task;
+        tcb[head].prev = task;
+    }
+    // periodic tasks are also kept in deadline order for edf
+    if(tcb[task].period)
+        edfInsert(task);
+}
+
+// remove a task from the ready list of its current priority
+void readyRemove(uint8_t task)
+{
+    uint8_t prio = tcb[task].currentPriority;
+    if(tcb[task].next == task)
+    {
+        readyHead[prio] = NO_TASK;
+        readyPriorities &= ~PRIORITY_BIT(prio);
+    }
+    else
+    {
+        tcb[tcb[task].prev].next = tcb[task].next;
+        tcb[tcb[task].next].prev = tcb[task].prev;
+        if(readyHead[prio] == task)
+            readyHead[prio] = tcb[task].next;
+    }
+    if(tcb[task].period)
+        edfRemove(task);
+}
+
+// mark a task ready and queue it
+void makeReady(uint8_t task)
+{
+    if(tcb[task].state != STATE_READY)
+    {
+        tcb[task].state = STATE_READY;
+        readyInsert(task);
+        tcb[task].woken = true;
+        tcb[task].wakeCycles = DWT_CYCCNT_R;
+    }
+}
+
+// check whether a thread is the last one left at the idle priority
+// the scheduler relies on that thread always being ready, so it cannot be killed or moved
+bool lastIdleTask(uint8_t task)
+{
+    uint8_t i;
+    if(tcb[task].priority != IDLE_PRIORITY || tcb[task].state == STATE_STOPPED)
+        return false;
+    for(i = 0; i < MAX_TASKS; i++)
+    {
+        if(i != task && tcb[i].priority == IDLE_PRIORITY
+                && tcb[i].state != STATE_INVALID && tcb[i].state != STATE_STOPPED)
+            return false;
+    }
+    return true;
+}
+
+// check whether a ready task should run before the running task
+bool outranksCurrent(uint8_t task)
+{
+    if(schedPolicy == SCHED_RR)
+        return false;
+    if(schedPolicy == SCHED_EDF && (tcb[task].period || tcb[taskCurrent].period))
+    {
+        if(!tcb[task].period)
+            return false;
+        if(!tcb[taskCurrent].period)
+            return true;
+        return !TICK_REACHED(tcb[task].deadline, tcb[taskCurrent].deadline);
+    }
+    return tcb[task].currentPriority < tcb[taskCurrent].currentPriority;
+}
+
+// check whether any ready task should now run before the running task
+// used after the running task drops an inherited or ceiling priority
+bool readyOutranksCurrent(void)
+{
+    if(schedPolicy == SCHED_EDF && edfHead != NO_TASK && edfHead != taskCurrent)
+        return outranksCurrent(edfHead);
+    return schedPolicy == SCHED_PRIO && clz(readyPriorities) < tcb[taskCurrent].currentPriority;
+}
+
+// move a task out of the ready state
+void makeUnready(uint8_t task, uint8_t state)
+{
+    if(tcb[task].state == STATE_READY)
+        readyRemove(task);
+    tcb[task].state = state;
+}
+
+// add a task to a wait queue
+// in priority order a task goes behind every task of the same or higher priority
+void waitInsert(waitQueue *queue, uint8_t task)
+{
+    uint8_t prev = queue->tail;
+    if(queue->order == WAIT_PRIORITY)
+    {
+        while(prev != NO_TASK && tcb[prev].currentPriority > tcb[task].currentPriority)
+            prev = tcb[prev].waitPrev;
+    }
+    tcb[task].waitPrev = prev;
+    if(prev == NO_TASK)
+    {
+        tcb[task].waitNext = queue->head;
+        queue->head = task;
+    }
+    else
+    {
+        tcb[task].waitNext = tcb[prev].waitNext;
+        tcb[prev].waitNext = task;
+    }
+    if(tcb[task].waitNext == NO_TASK)
+        queue->tail = task;
+    else
+        tcb[tcb[task].waitNext].waitPrev = task;
+}
+
+// take a task out of a wait queue
+void waitRemove(waitQueue *queue, uint8_t task)
+{
+    if(tcb[task].waitPrev == NO_TASK)
+        queue->head = tcb[task].waitNext;
+    else
+        tcb[tcb[task].waitPrev].waitNext = tcb[task].waitNext;
+    if(tcb[task].waitNext == NO_TASK)
+        queue->tail = tcb[task].waitPrev;
+    else
+        tcb[tcb[task].waitNext].waitPrev = tcb[task].waitPrev;
+}
+
+// take the next task to wake out of a wait queue, or NO_TASK if it is empty
+uint8_t waitPop(waitQueue *queue)
+{
+    uint8_t task = queue->head;
+    if(task != NO_TASK)
+        waitRemove(queue, task);
+    return task;
+}
+
+// the wait queue a blocked task is on, or 0 if it is not blocked on a kernel object
+waitQueue* waitQueueOf(uint8_t task)
+{
+    if(tcb[task].state == STATE_BLOCKED_MUTEX)
+        return &mutexes[tcb[task].mutex].queue;
+    if(tcb[task].state == STATE_BLOCKED_SEMAPHORE)
+        return &semaphores[tcb[task].semaphore].queue;
+    if(tcb[task].state == STATE_BLOCKED_EVENT)
+        return &eventGroups[tcb[task].eventGroup].queue;
+    if(tcb[task].state == STATE_BLOCKED_CALL)
+        return &tcb[tcb[task].ipcServer].callers;
+    if(tcb[task].state == STATE_BLOCKED_CONDITION)
+        return &conditions[tcb[task].condition].queue;
+    if(tcb[task].state == STATE_BLOCKED_RWLOCK)
+    {
+        if(tcb[task].rwWrite)
+            return &rwlocks[tcb[task].rwlock].writeQueue;
+        return &rwlocks[tcb[task].rwlock].readQueue;
+    }
+    if(tcb[task].state == STATE_BLOCKED_QUEUE)
+    {
+        if(tcb[task].msgSend)
+            return &msgQueues[tcb[task].msgQueue].senders;
+        return &msgQueues[tcb[task].msgQueue].receivers;
+    }
+    return 0;
+}
+
+// change the priority a task is scheduled at, moving it to the matching ready list
+// (or to its new place in a priority ordered wait queue)
+void setCurrentPriority(uint8_t task, uint8_t priority)
+{
+    waitQueue *queue = waitQueueOf(task);
+    if(tcb[task].state == STATE_READY)
+    {
+        readyRemove(task);
+        tcb[task].currentPriority = priority;
+        readyInsert(task);
+    }
+    else if(queue != 0 && queue->order == WAIT_PRIORITY)
+    {
+        waitRemove(queue, task);
+        tcb[task].currentPriority = priority;
+        waitInsert(queue, task);
+    }
+    else
+        tcb[task].currentPriority = priority;
+}
 
-        case UNLOCK:
+// recompute the effective priority of a task from its base priority, the ceilings
+// of the mutexes it holds and, with priority inheritance, the waiters on them and
+// on the reader-writer locks it holds (only the waiting writers for a read hold)
+// a change is passed along the chain of owners the task is blocked behind
+void updatePriority(uint8_t task)
+{
+    uint8_t m, q, prio, hops;
+    for(hops = 0; hops < MAX_TASKS; hops++)
+    {
+        prio = tcb[task].priority;
+        for(m = 0; m < MAX_MUTEXES; m++)
         {
-            uint8_t mutexCurrent = getR0();
-            uint8_t i;
-            if(mutexes[mutexCurrent].lockedBy == taskCurrent)
+            if(mutexes[m].lock && mutexes[m].lockedBy == task)
             {
-                mutexes[mutexCurrent].lock = false;
-                if(mutexes[mutexCurrent].queueSize)
+                if(mutexes[m].ceiling < prio)
+                    prio = mutexes[m].ceiling;
+                if(priorityInheritance)
                 {
-                    tcb[mutexes[mutexCurrent].processQueue[0]].state = STATE_READY;
-                    mutexes[mutexCurrent].lock = true;
-                    mutexes[mutexCurrent].lockedBy = mutexes[mutexCurrent].processQueue[0];
-                    for (i = 0; i < mutexes[mutexCurrent].queueSize; i++)
+                    for(q = mutexes[m].queue.head; q != NO_TASK; q = tcb[q].waitNext)
                     {
-                        mutexes[mutexCurrent].processQueue[i] = mutexes[mutexCurrent].processQueue[i + 1];
+                        if(tcb[q].currentPriority < prio)
+                            prio = tcb[q].currentPriority;
                     }
-                    mutexes[mutexCurrent].queueSize--;
                 }
             }
-            break;
         }
-
-        case WAIT:
-        {
-           uint8_t semaphoreCurrent = getR0();
-           if(semaphores[semaphoreCurrent].count > 0)
-           {
-               semaphores[semaphoreCurrent].count--;
-               break;
-           }
-           else
-           {
-               tcb[taskCurrent].semaphore = semaphoreCurrent;
-               semaphores[semaphoreCurrent].processQueue[semaphores[semaphoreCurrent].queueSize] = taskCurrent;
-               semaphores[semaphoreCurrent].queueSize++;
-               tcb[taskCurrent].state = STATE_BLOCKED_SEMAPHORE;
-               NVIC_INT_CTRL_R |= NVIC_INT_CTRL_PEND_SV;  // Enable pendsv
-           }
-
-           break;
-        }
-
-        case POST:
+        for(m = 0; m < MAX_RWLOCKS && priorityInheritance; m++)
         {
-            uint8_t semaphoreCurrent = getR0();
-            semaphores[semaphoreCurrent].count++;
-            if(semaphores[semaphoreCurrent].queueSize)
+            if(rwlocks[m].slot.used && rwlocks[m].writer == task)
             {
-                tcb[semaphores[semaphoreCurrent].processQueue[0]].state = STATE_READY;
-                if(semaphores[semaphoreCurrent].queueSize == MAX_SEMAPHORE_QUEUE_SIZE)
+                for(q = rwlocks[m].writeQueue.head; q != NO_TASK; q = tcb[q].waitNext)
                 {
-                    semaphores[semaphoreCurrent].processQueue[0] = semaphores[semaphoreCurrent].processQueue[1];
+                    if(tcb[q].currentPriority < prio)
+                        prio = tcb[q].currentPriority;
+                }
+                for(q = rwlocks[m].readQueue.head; q != NO_TASK; q = tcb[q].waitNext)
+                {
+                    if(tcb[q].currentPriority < prio)
+                        prio = tcb[q].currentPriority;
                 }
-                semaphores[semaphoreCurrent].queueSize--;
-                semaphores[semaphoreCurrent].count--;
             }
-            break;
-        }
-        case MALLOC:
-        {
-            uint64_t srdMask = 0;
-            uint32_t size = getR0();
-            void* allocatedAddr = mallocFromHeap(size);
-            addSramAccessWindow(&srdMask, allocatedAddr, size);
-            applySramAccessMask(srdMask);
-            putR0((uint32_t) allocatedAddr);
-            break;
-        }
-        case REBOOT:
-        {
-            putsUart0("Rebooted Successfully....\n\n");
-            putsUart0("Welcome to the TIVA C RTOS Environment\n\n");
-            putsUart0("\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\n");
-            NVIC_APINT_R = NVIC_APINT_VECTKEY | NVIC_APINT_SYSRESETREQ;
-            break;
-        }
-        case PS:
-        {
-        }
-        case KILL:
-        {
-            uint32_t killPid = (uint32_t) getR0();
-            uint8_t i, j;
-            for(i = 0; i < MAX_TASKS; i++)
+            else if(tcb[task].rwReading & (1 << m))
             {
-                if((uint32_t) tcb[i].pid == killPid)
+                for(q = rwlocks[m].writeQueue.head; q != NO_TASK; q = tcb[q].waitNext)
                 {
-                    if(mutexes[resource].lockedBy == i)                 // if the task to kill has the mutex
-                    {
-                        mutexes[resource].lock = false;
-                        if(mutexes[resource].queueSize)
-                        {
-                            tcb[mutexes[resource].processQueue[0]].state = STATE_READY;
-                            mutexes[resource].lock = true;
-                            mutexes[resource].lockedBy = mutexes[resource].processQueue[0];
-                            for (i = 0; i < mutexes[resource].queueSize; i++)
-                            {
-                                mutexes[resource].processQueue[i] = mutexes[resource].processQueue[i + 1];
-                            }
-                            mutexes[resource].queueSize--;
-                        }
-                    }
-                    else if(tcb[i].state == STATE_BLOCKED_MUTEX)        // if the task to kill is blocked by a mutex
-                    {
-                        if(mutexes[resource].processQueue[j] == i)
-                        {
-                            if(j < mutexes[resource].queueSize)
-                            {
-                                for (j = 0; j < mutexes[resource].queueSize; j++)
-                                {
-                                    mutexes[resource].processQueue[j] = mutexes[resource].processQueue[j + 1];
-                                    mutexes[resource].queueSize--;
-                                }
-                            }
-                            else if(j == mutexes[resource].queueSize)
-                                mutexes[resource].queueSize--;
-                        }
-                    }
-                    else if(tcb[i].state == STATE_BLOCKED_SEMAPHORE)    // if the task is blocked by a semaphore
-                    {
-                        if(semaphores[resource].processQueue[j] == i)
-                        {
-                            if(j < semaphores[resource].queueSize)
-                            {
-                                for (j = 0; j < semaphores[resource].queueSize; j++)
-                                {
-                                    semaphores[resource].processQueue[j] = semaphores[resource].processQueue[j + 1];
-                                    semaphores[resource].queueSize--;
-                                }
-                            }
-                            else if(j == semaphores[resource].queueSize)
-                                semaphores[resource].queueSize--;
-                        }
-                    }
-                    freeToHeap(tcb[i].mallocated);
-                    // update the tcb for the task
-                    tcb[i].mutex      = 0;
-                    tcb[i].semaphore  = 0;
-                    tcb[i].ticks      = 0;
-                    tcb[i].state      = STATE_STOPPED;
-                    break;
+                    if(tcb[q].currentPriority < prio)
+                        prio = tcb[q].currentPriority;
                 }
             }
-            char str[20] = {0,};
-            putsUart0("\nKilled :\t");
-            print(killPid, str, 10);
-            NVIC_INT_CTRL_R |= NVIC_INT_CTRL_PEND_SV;  // Enable pendsv
-            break;
         }
-        case PREEMPT:
+        if(prio == tcb[task].currentPriority)
+            break;
+        setCurrentPriority(task, prio);
+        if(tcb[task].state == STATE_BLOCKED_MUTEX)
+            task = mutexes[tcb[task].mutex].lockedBy;
+        else if(tcb[task].state == STATE_BLOCKED_RWLOCK && rwlocks[tcb[task].rwlock].writer != NO_TASK)
+            task = rwlocks[tcb[task].rwlock].writer;
+        else
         {
-            bool preempt = getR0();
-            if(preempt)
-            {
-                preemption = true;
-                putsUart0("Preemption turned ON\n");
-            }
-            else
+            // a writer blocked behind readers passes the change on to each of them
+            if(tcb[task].state == STATE_BLOCKED_RWLOCK && tcb[task].rwWrite)
             {
-                preemption = false;
-                putsUart0("Preemption turn OFF\n");
+                m = tcb[task].rwlock;
+                for(q = 0; q < MAX_TASKS; q++)
+                {
+                    if(tcb[q].rwReading & (1 << m))
+                        updatePriority(q);
+                }
             }
             break;
         }
-        case SCHED:
+    }
+}
+
+// recompute the priority of every task holding a reader-writer lock for reading
+// after the writers waiting on it change
+void rwReadersUpdate(uint8_t lock)
+{
+    uint8_t task;
+    for(task = 0; task < MAX_TASKS; task++)
+    {
+        if(tcb[task].rwReading & (1 << lock))
+            updatePriority(task);
+    }
+}
+
+// add a task to the sleep timer list, after any task waking on the same tick
+void timerInsert(uint8_t task, uint32_t wakeTick)
+{
+    uint8_t prev = NO_TASK;
+    uint8_t next = timerHead;
+    while(next != NO_TASK && TICK_REACHED(wakeTick, tcb[next].wakeTick))
+    {
+        prev = next;
+        next = tcb[next].timerNext;
+    }
+    tcb[task].wakeTick = wakeTick;
+    tcb[task].timerPrev = prev;
+    tcb[task].timerNext = next;
+    if(prev == NO_TASK)
+        timerHead = task;
+    else
+        tcb[prev].timerNext = task;
+    if(next != NO_TASK)
+        tcb[next].timerPrev = task;
+}
+
+// remove a task from the sleep timer list
+void timerRemove(uint8_t task)
+{
+    uint8_t prev = tcb[task].timerPrev;
+    uint8_t next = tcb[task].timerNext;
+    if(prev == NO_TASK)
+        timerHead = next;
+    else
+        tcb[prev].timerNext = next;
+    if(next != NO_TASK)
+        tcb[next].timerPrev = prev;
+}
+
+// stop the timeout of a task that was blocked with one
+void timeoutCancel(uint8_t task)
+{
+    if(tcb[task].timeout)
+    {
+        timerRemove(task);
+        tcb[task].timeout = false;
+    }
+}
+
+// hand a mutex to the first task waiting on it, or free it
+// returns the task that was handed the mutex, or NO_TASK
+uint8_t mutexRelease(uint8_t mutex)
+{
+    uint8_t next = waitPop(&mutexes[mutex].queue);
+    mutexes[mutex].lock = false;
+    if(next != NO_TASK)
+    {
+        timeoutCancel(next);
+        mutexes[mutex].lock = true;
+        mutexes[mutex].lockedBy = next;
+        tcb[next].mutex = mutex;
+        makeReady(next);
+        updatePriority(next);
+
+        // track the worst case time spent waiting for a mutex
+        uint32_t blocked = DWT_CYCCNT_R - tcb[next].blockStart;
+        if(blocked > tcb[next].maxBlocked)
+            tcb[next].maxBlocked = blocked;
+    }
+
+    // a fast mutex is only held in the kernel while tasks are blocked on it
+    if(mutexes[mutex].word != 0)
+    {
+        if(next == NO_TASK)
+            *mutexes[mutex].word = 0;
+        else if(mutexes[mutex].queue.head == NO_TASK)
         {
-            bool sched = getR0();
-            if(sched)
-            {
-                priorityScheduler = true;
-                putsUart0("Priority Scheduling is now selected\n");
-            }
-            else
-            {
-                priorityScheduler = false;
-                putsUart0("Round Robin Scheduling is now selected\n");
-            }
-            NVIC_INT_CTRL_R |= NVIC_INT_CTRL_PEND_SV;  // Enable pendsv
-            break;
+            *mutexes[mutex].word = MAKE_HANDLE(next, tcb[next].generation);
+            mutexes[mutex].lock = false;
         }
-        case PIDOF:
+        else
+            *mutexes[mutex].word = MAKE_HANDLE(next, tcb[next].generation) | FAST_WAITERS;
+    }
+    return next;
+}
+
+// take a task out of the wait queue of the mutex it is blocked on
+void mutexQueueRemove(uint8_t task)
+{
+    uint8_t mutex = tcb[task].mutex;
+    waitRemove(&mutexes[mutex].queue, task);
+    updatePriority(mutexes[mutex].lockedBy);
+}
+
+// take a task out of the wait queue of the semaphore it is blocked on
+void semaphoreQueueRemove(uint8_t task)
+{
+    uint8_t semaphore = tcb[task].semaphore;
+    waitRemove(&semaphores[semaphore].queue, task);
+}
+
+// add a semaphore count or hand it straight to the first waiter
+// a switch to the woken task is requested through PendSV, so this is safe from an interrupt handler
+void semaphorePost(uint8_t semaphore)
+{
+    uint8_t next = waitPop(&semaphores[semaphore].queue);
+    if(next != NO_TASK)
+    {
+        timeoutCancel(next);
+        makeReady(next);
+        if(outranksCurrent(next))
+            NVIC_INT_CTRL_R |= NVIC_INT_CTRL_PEND_SV;  // switch to the woken task now
+    }
+    else
+        semaphores[semaphore].count++;
+}
+
+// the exception frame (stacked R0-R3, R12, LR, PC, xPSR) of a task that is switched out
+uint32_t* taskFrame(uint8_t task)
+{
+    uint32_t *sp = (uint32_t*) tcb[task].sp;
+    // R4-R11 and EXEC_RETURN, then S16-S31 when EXEC_RETURN shows an FPU context
+    return sp + 9 + ((sp[8] & 0x10) ? 0 : 16);
+}
+
+// check whether a set of flags satisfies an event wait
+bool eventMatch(uint32_t flags, uint32_t mask, uint8_t options)
+{
+    if(options & EVENT_WAIT_ALL)
+        return (flags & mask) == mask;
+    return (flags & mask) != 0;
+}
+
+// set flags in an event group and wake every waiter they satisfy
+// each woken waiter returns the flags as they were set, before any clear on exit
+void eventSet(uint8_t group, uint32_t flags)
+{
+    uint8_t task, next;
+    uint32_t clear = 0;
+    eventGroups[group].flags |= flags;
+    flags = eventGroups[group].flags;
+    for(task = eventGroups[group].queue.head; task != NO_TASK; task = next)
+    {
+        next = tcb[task].waitNext;
+        if(eventMatch(flags, tcb[task].eventMask, tcb[task].eventOptions))
         {
-            uint8_t proc;
-            uint32_t pid;
-            char* process = (char*) getR0();
-            for(proc = 0; proc < MAX_TASKS; proc++)
-            {
-                if(stringCmp(tcb[proc].name, process) == 0)
-                {
-                    pid = (uint32_t) tcb[proc].pid;
-                    break;
-                }
-            }
-            putR0(pid);
-            break;
+            if(tcb[task].eventOptions & EVENT_CLEAR)
+                clear |= tcb[task].eventMask;
+            waitRemove(&eventGroups[group].queue, task);
+            timeoutCancel(task);
+            taskFrame(task)[0] = flags;
+            makeReady(task);
+            if(outranksCurrent(task))
+                NVIC_INT_CTRL_R |= NVIC_INT_CTRL_PEND_SV;
         }
     }
+    eventGroups[group].flags &= ~clear;
+}
+
+// copy one message (a pointer in a pointer queue)
+void msgCopy(msgQueue *queue, void *dest, const void *src)
+{
+    uint16_t i;
+    if(queue->itemSize == 0)
+        *(void**) dest = *(void* const*) src;
+    else
+    {
+        for(i = 0; i < queue->itemSize; i++)
+            ((uint8_t*) dest)[i] = ((const uint8_t*) src)[i];
+    }
+}
+
+// address of a slot in the storage of a message queue
+void* msgSlot(msgQueue *queue, uint16_t slot)
+{
+    uint16_t size = (queue->itemSize == 0) ? sizeof(void*) : queue->itemSize;
+    if(slot >= queue->depth)
+        slot -= queue->depth;
+    return queue->storage + slot * size;
+}
+
+// block the running task on a message queue
+void msgBlock(uint8_t queue, bool send, void *buffer, uint32_t ticks)
+{
+    tcb[taskCurrent].msgQueue = queue;
+    tcb[taskCurrent].msgSend = send;
+    tcb[taskCurrent].msgBuffer = buffer;
+    makeUnready(taskCurrent, STATE_BLOCKED_QUEUE);
+    waitInsert(waitQueueOf(taskCurrent), taskCurrent);
+    if(ticks != WAIT_FOREVER)
+    {
+        tcb[taskCurrent].timeout = true;
+        timerInsert(taskCurrent, tickCount + ticks);
+    }
+    NVIC_INT_CTRL_R |= NVIC_INT_CTRL_PEND_SV;
+}
+
+// wake a task blocked on a message queue, its call returns true
+void msgWake(waitQueue *waiters, uint8_t task)
+{
+    waitRemove(waiters, task);
+    timeoutCancel(task);
+    taskFrame(task)[0] = true;
+    makeReady(task);
+    if(outranksCurrent(task))
+        NVIC_INT_CTRL_R |= NVIC_INT_CTRL_PEND_SV;
+}
+
+// switch to a task that was just made ready, skipping the scheduler when no other ready
+// task outranks it, so a call and its reply keep the cpu within the client and server
+void switchDirect(uint8_t task)
+{
+    if(schedPolicy == SCHED_RR || (schedPolicy == SCHED_PRIO && clz(readyPriorities) >= tcb[task].currentPriority))
+        directTask = task;
+    NVIC_INT_CTRL_R |= NVIC_INT_CTRL_PEND_SV;
+}
+
+// move a call message (R0-R3) between exception frames
+// the partner's handle and the service call number go in R12 of the destination
+void ipcCopy(uint32_t *dest, const uint32_t *src, uint8_t partner, uint8_t svcNo)
+{
+    dest[0] = src[0];
+    dest[1] = src[1];
+    dest[2] = src[2];
+    dest[3] = src[3];
+    dest[4] = ((uint32_t) MAKE_HANDLE(partner, tcb[partner].generation) << 8) | svcNo;
+}
+
+// fail every call waiting on or being served by a server that is going away
+void ipcAbort(uint8_t server)
+{
+    uint8_t task;
+    for(task = 0; task < MAX_TASKS; task++)
+    {
+        if((tcb[task].state == STATE_BLOCKED_CALL || tcb[task].state == STATE_BLOCKED_REPLY)
+                && tcb[task].ipcServer == server)
+        {
+            if(tcb[task].state == STATE_BLOCKED_CALL)
+                waitRemove(&tcb[server].callers, task);
+            taskFrame(task)[4] = CALL;          // no partner: call() returns false
+            makeReady(task);
+        }
+    }
+}
+
+// move a task signalled on a condition variable to its mutex
+// it owns the mutex at once if it is free, otherwise it queues for it like a lock()
+// so signalling while holding the mutex does not wake the task just to block again
+void conditionMove(uint8_t task)
+{
+    uint8_t mutex = tcb[task].mutex;
+    if(!mutexes[mutex].lock)
+    {
+        mutexes[mutex].lock = true;
+        mutexes[mutex].lockedBy = task;
+        makeReady(task);
+        updatePriority(task);                   // take the ceiling of the mutex
+        if(outranksCurrent(task))
+            NVIC_INT_CTRL_R |= NVIC_INT_CTRL_PEND_SV;
+    }
+    else
+    {
+        tcb[task].state = STATE_BLOCKED_MUTEX;
+        tcb[task].blockStart = DWT_CYCCNT_R;
+        waitInsert(&mutexes[mutex].queue, task);
+        updatePriority(mutexes[mutex].lockedBy);
+    }
+}
+
+// wake a task that was waiting for a reader-writer lock it now holds
+void rwWake(uint8_t task)
+{
+    makeReady(task);
+    if(outranksCurrent(task))
+        NVIC_INT_CTRL_R |= NVIC_INT_CTRL_PEND_SV;
+}
+
+// hand a reader-writer lock that has just become free to the waiters
+// a waiting writer goes first (writer preference), otherwise every waiting reader enters
+void rwGrant(uint8_t lock)
+{
+    uint8_t task = waitPop(&rwlocks[lock].writeQueue);
+    if(task != NO_TASK)
+    {
+        rwlocks[lock].writer = task;
+        rwWake(task);
+        updatePriority(task);                   // inherit from the waiters left behind
+    }
+    else
+    {
+        while((task = waitPop(&rwlocks[lock].readQueue)) != NO_TASK)
+        {
+            rwlocks[lock].readers++;
+            tcb[task].rwReading |= 1 << lock;
+            rwWake(task);
+        }
+    }
+}
+
+// release a reader-writer lock held for reading by a task
+void rwReadRelease(uint8_t lock, uint8_t task)
+{
+    tcb[task].rwReading &= ~(1 << lock);
+    rwlocks[lock].readers--;
+    updatePriority(task);                       // drop any priority inherited through the lock
+    if(rwlocks[lock].readers == 0)
+        rwGrant(lock);
+    if(task == taskCurrent && readyOutranksCurrent())
+        NVIC_INT_CTRL_R |= NVIC_INT_CTRL_PEND_SV;  // a task the inherited priority held off runs now
+}
+
+// release a reader-writer lock held for writing
+void rwWriteRelease(uint8_t lock)
+{
+    uint8_t task = rwlocks[lock].writer;
+    rwlocks[lock].writer = NO_TASK;
+    updatePriority(task);                       // drop any priority inherited through the lock
+    rwGrant(lock);
+    if(task == taskCurrent && readyOutranksCurrent())
+        NVIC_INT_CTRL_R |= NVIC_INT_CTRL_PEND_SV;  // a task the inherited priority held off runs now
+}
+
+// block the running task on a reader-writer lock
+void rwBlock(uint8_t lock, bool write)
+{
+    tcb[taskCurrent].rwlock = lock;
+    tcb[taskCurrent].rwWrite = write;
+    makeUnready(taskCurrent, STATE_BLOCKED_RWLOCK);
+    waitInsert(waitQueueOf(taskCurrent), taskCurrent);
+    if(rwlocks[lock].writer != NO_TASK)
+        updatePriority(rwlocks[lock].writer);
+    else if(write)
+        rwReadersUpdate(lock);                  // the readers inherit from the blocked writer
+    NVIC_INT_CTRL_R |= NVIC_INT_CTRL_PEND_SV;
+}
+
+// REQUIRED: Implement prioritization to NUM_PRIORITIES
+uint8_t rtosScheduler(void)
+{
+    bool ok;
+    uint32_t start = DWT_CYCCNT_R;
+    static uint8_t task = 0xFF;
+    ok = false;
+    if(schedPolicy == SCHED_EDF && edfHead != NO_TASK)
+    {
+        // earliest deadline first among the released periodic jobs
+        task = edfHead;
+    }
+    else if(schedPolicy != SCHED_RR)
+    {
+        // the highest ready priority is the leading set bit of the bitmap
+        uint8_t prio = clz(readyPriorities);
+        task = readyHead[prio];
+        readyHead[prio] = tcb[task].next;       // rotate so equal priorities take turns
+    }
+    else
+    {
+        while (!ok)
+        {
+            task++;
+            if (task >= MAX_TASKS)
+                task = 0;
+            ok = (tcb[task].state == STATE_READY);
+        }
+    }
+    benchRecord(BENCH_SCHED, start);
+    return task;
+}
+
+// REQUIRED: modify this function to start the operating system
+// by calling scheduler, set srd bits, setting PSP, ASP bit, call fn with fn add in R0
+// fn set TMPL bit, and PC <= fn
+void startRtos(void)
+{
+    setPsp(0x20008000);
+    setAsp();
+    switchToUnprivilegedMode();
+    __asm(" MOV R12, #0x00");
+    __asm(" SVC #0x00");
+}
+
+// build the initial stack of a task so it seems like it ran before
+// the layout below the hardware frame matches pendSvIsr: R4-R11 then EXEC_RETURN
+// (tasks start with a basic frame, the hardware switches to an extended
+// frame with FPU state once the task executes its first FPU instruction)
+void* initStack(void* top, _fn fn)
+{
+    uint32_t* p = top;
+    *(--p) = (1 << 24);                                         // set the valid bit (thumb) in the EPSR (xPSR)
+    *(--p) = (uint32_t) fn;                                     // PC
+    *(--p) = 0xAAAABBBB;                                        // LR
+    *(--p) = 0X0000000C;                                        // R12
+    *(--p) = 0X00000003;                                        // R3
+    *(--p) = 0X00000002;                                        // R2
+    *(--p) = 0X00000001;                                        // R1
+    *(--p) = 0X00000000;                                        // R0
+    *(--p) = 0XFFFFFFFD;                                        // EXEC_RETURN
+    *(--p) = 0XAAAAAAAA;                                        // R11
+    *(--p) = 0XAAAAAAAA;                                        // R10
+    *(--p) = 0XAAAAAAAA;                                        // R9
+    *(--p) = 0XAAAAAAAA;                                        // R8
+    *(--p) = 0XAAAAAAAA;                                        // R7
+    *(--p) = 0XAAAAAAAA;                                        // R6
+    *(--p) = 0XAAAAAAAA;                                        // R5
+    *(--p) = 0XAAAAAAAA;                                        // R4
+    return p;
+}
+
+// Create Thread:
+// add task if room in task list
+// store the thread name
+// allocate stack space and store top of stack in sp and spInit
+// set the srd bits based on the memory allocation
+// initialize the created stack to make it appear the thread has run before
+// returns the handle of the thread, or INVALID_HANDLE if it could not be added
+threadHandle createThread(_fn fn, const char name[], uint8_t priority, uint32_t stackBytes)
+{
+    threadHandle thread = INVALID_HANDLE;
+    uint8_t i = 0;
+    bool found = false;
+    if (taskCount < MAX_TASKS && priority < NUM_PRIORITIES)
+    {
+        // make sure fn not already in list (prevent reentrancy)
+        while (!found && (i < MAX_TASKS))
+        {
+            found = (tcb[i++].pid ==  fn);
+        }
+        if (!found)
+        {
+            // find first available tcb record
+            i = 0;
+            while (tcb[i].state != STATE_INVALID) {i++;}
+
+            // found an available record
+            void* baseAddr = mallocFromHeap(stackBytes);
+            tcb[i].mallocated = baseAddr;
+            tcb[i].size = stackBytes;
+            tcb[i].pid = fn;
+            tcb[i].generation = nextGeneration(tcb[i].generation);
+            tcb[i].sp = (void*)((uint32_t) baseAddr + stackBytes);
+            tcb[i].spInit = (void*)((uint32_t) baseAddr + stackBytes);
+            tcb[i].priority = priority;
+            tcb[i].currentPriority = priority;
+            tcb[i].period = 0;
+            tcb[i].deadlineMisses = 0;
+            tcb[i].callers.head = NO_TASK;
+            tcb[i].callers.tail = NO_TASK;
+            tcb[i].callers.order = WAIT_PRIORITY;
+            tcb[i].wakeTick = 0;
+            addSramAccessWindow(&tcb[i].srd, (uint32_t*) baseAddr, stackBytes);
+            copyString(tcb[i].name, name);
+            makeReady(i);
+
+            // make the task seem like it ran before
+            tcb[i].sp = initStack(tcb[i].sp, fn);
+
+            // increment task count
+            taskCount++;
+            thread = MAKE_HANDLE(i, tcb[i].generation);
+        }
+    }
+    return thread;
+}
+
+// Admission Test:
+// computes the worst-case response time of every periodic task that declared a wcet
+// (exact response-time analysis, tasks at the same priority are counted as interference)
+// and returns whether the set meets its deadlines under the current policy
+// edf is accepted when the total density (wcet / min(deadline, period)) is at most 1
+bool admissionTest(void)
+{
+    uint8_t i, j;
+    uint32_t r, next, window;
+    uint64_t density = 0;
+    bool ok = true;
+    for (i = 0; i < MAX_TASKS; i++)
+    {
+        if (tcb[i].state == STATE_INVALID || tcb[i].period == 0 || tcb[i].wcet == 0)
+            continue;
+
+        // density in units of 1/65536
+        window = (tcb[i].relDeadline < tcb[i].period) ? tcb[i].relDeadline : tcb[i].period;
+        density += (((uint64_t) tcb[i].wcet << 16) + window - 1) / window;
+
+        // iterate r = C + sum(ceil(r / Tj) * Cj) until it settles or passes the deadline
+        r = tcb[i].wcet;
+        next = 0;
+        while (r <= tcb[i].relDeadline && next != r)
+        {
+            if (next != 0)
+                r = next;
+            next = tcb[i].wcet;
+            for (j = 0; j < MAX_TASKS; j++)
+            {
+                if (j != i && tcb[j].state != STATE_INVALID && tcb[j].period != 0 && tcb[j].wcet != 0
+                        && tcb[j].priority <= tcb[i].priority)
+                    next += ((r + tcb[j].period - 1) / tcb[j].period) * tcb[j].wcet;
+            }
+        }
+        tcb[i].responseTime = r;
+        if (schedPolicy != SCHED_EDF && r > tcb[i].relDeadline)
+            ok = false;
+    }
+    if (schedPolicy == SCHED_EDF && density > 0x10000)
+        ok = false;
+    return ok;
+}
+
+// Create Periodic Thread:
+// add a thread that is released every period ticks and whose jobs must complete
+// within deadline ticks of their release (0 = the period)
+// each job ends by calling waitPeriod()
+// a thread that declares its wcet is only added if the admission test still passes
+threadHandle createPeriodicThread(_fn fn, const char name[], uint8_t priority, uint32_t period, uint32_t deadline, uint32_t wcet, uint32_t stackBytes)
+{
+    uint8_t i;
+    threadHandle thread = (period > 0) ? createThread(fn, name, priority, stackBytes) : INVALID_HANDLE;
+    if (thread != INVALID_HANDLE)
+    {
+        i = HANDLE_INDEX(thread);
+
+        // the first job is released now
+        readyRemove(i);
+        tcb[i].period = period;
+        tcb[i].relDeadline = (deadline > 0) ? deadline : period;
+        tcb[i].wcet = wcet;
+        tcb[i].release = tickCount;
+        tcb[i].deadline = tickCount + tcb[i].relDeadline;
+        readyInsert(i);
+
+        // reject the thread if the task set can no longer meet its deadlines
+        if (wcet != 0 && !admissionTest())
+        {
+            readyRemove(i);
+            freeToHeap(tcb[i].mallocated);
+            tcb[i].state = STATE_INVALID;
+            tcb[i].pid = 0;
+            tcb[i].srd = 0;
+            tcb[i].sharedSrd = 0;
+            tcb[i].period = 0;
+            taskCount--;
+            admissionTest();
+            thread = INVALID_HANDLE;
+        }
+    }
+    return thread;
+}
+
+// REQUIRED: modify this function to restart a thread
+void restartThread(threadHandle thread)
+{
+    __asm(" MOV R12, #0x01");
+    __asm(" SVC #0x01");
+}
+
+// REQUIRED: modify this function to stop a thread
+// REQUIRED: remove any pending semaphore waiting, unlock any mutexes
+void stopThread(threadHandle thread)
+{
+    __asm(" MOV R12, #0x0C");
+    __asm(" SVC #0x0C");
+}
+
+// REQUIRED: modify this function to set a thread priority
+void setThreadPriority(threadHandle thread, uint8_t priority)
+{
+    __asm(" MOV R12, #0x02");
+    __asm(" SVC #0x02");
+}
+
+// yield execution back to scheduler using pendsv
+void yield(void)
+{
+    __asm(" MOV R12, #0x03");
+    __asm(" SVC #0x03");
+}
+
+// execution yielded back to scheduler until time elapses using pendsv
+void sleep(uint32_t tick)
+{
+    __asm(" MOV R12, #0x04");
+    __asm(" SVC #0x04");
+}
+
+// sleep until the tick count reaches tick (for drift-free periodic work)
+void sleepUntil(uint32_t tick)
+{
+    __asm(" MOV R12, #0x18");
+    __asm(" SVC #0x18");
+}
+
+// ticks since the kernel started
+uint32_t getTicks(void)
+{
+    __asm(" MOV R12, #0x19");
+    __asm(" SVC #0x19");
+}
+
+// Function to lock a mutex using pendsv
+void lock(mutexHandle mutex)
+{
+    __asm(" MOV R12, #0x05");
+    __asm(" SVC #0x05");
+}
+
+// lock a mutex, giving up after ticks (0 = only if it is free)
+// returns true if the mutex was locked
+bool lockTimeout(mutexHandle mutex, uint32_t ticks)
+{
+    __asm(" MOV R12, #0x16");
+    __asm(" SVC #0x16");
+}
+
+// function to unlock a mutex using pendsv
+void unlock(mutexHandle mutex)
+{
+    __asm(" MOV R12, #0x06");
+    __asm(" SVC #0x06");
+}
+
+// contended paths of fastLock() and fastUnlock()
+void fastLockSlow(fastMutex *fast)
+{
+    __asm(" MOV R12, #0x21");
+    __asm(" SVC #0x21");
+}
+
+void fastUnlockSlow(fastMutex *fast)
+{
+    __asm(" MOV R12, #0x22");
+    __asm(" SVC #0x22");
+}
+
+// unlock mutex and wait on a condition variable, as one step
+// the mutex is locked again before returning
+// returns false if the caller does not hold the mutex
+bool condWait(condHandle cv, mutexHandle mutex)
+{
+    __asm(" MOV R12, #0x23");
+    __asm(" SVC #0x23");
+}
+
+// wake the highest priority task waiting on a condition variable
+void condSignal(condHandle cv)
+{
+    __asm(" MOV R12, #0x24");
+    __asm(" SVC #0x24");
+}
+
+// wake every task waiting on a condition variable
+// they take the mutex one at a time
+void condBroadcast(condHandle cv)
+{
+    __asm(" MOV R12, #0x25");
+    __asm(" SVC #0x25");
+}
+
+// lock a reader-writer lock for reading (shared with other readers)
+void readLock(rwlockHandle lock)
+{
+    __asm(" MOV R12, #0x26");
+    __asm(" SVC #0x26");
+}
+
+void readUnlock(rwlockHandle lock)
+{
+    __asm(" MOV R12, #0x27");
+    __asm(" SVC #0x27");
+}
+
+// lock a reader-writer lock for writing (exclusive)
+void writeLock(rwlockHandle lock)
+{
+    __asm(" MOV R12, #0x28");
+    __asm(" SVC #0x28");
+}
+
+void writeUnlock(rwlockHandle lock)
+{
+    __asm(" MOV R12, #0x29");
+    __asm(" SVC #0x29");
+}
+
+// lock a fast mutex
+// an unlocked mutex is taken with LDREX/STREX without entering the kernel
+void fastLock(fastMutex *fast)
+{
+    if(!fastTryLock(&fast->owner, getPid()))
+        fastLockSlow(fast);
+}
+
+// unlock a fast mutex
+// the kernel is only entered when tasks are waiting for the mutex
+void fastUnlock(fastMutex *fast)
+{
+    if(!fastTryUnlock(&fast->owner, getPid()))
+        fastUnlockSlow(fast);
+}
+
+// function to wait a semaphore using pendsv
+void wait(semaphoreHandle semaphore)
+{
+    __asm(" MOV R12, #0x07");
+    __asm(" SVC #0x07");
+}
+
+// wait on a semaphore, giving up after ticks (0 = only if a count is available)
+// returns true if the semaphore was taken
+bool waitTimeout(semaphoreHandle semaphore, uint32_t ticks)
+{
+    __asm(" MOV R12, #0x17");
+    __asm(" SVC #0x17");
+}
+
+// set flags in an event group, waking the tasks waiting for them
+// returns the flags left set once the woken waiters have cleared theirs
+uint32_t setEvents(eventHandle group, uint32_t flags)
+{
+    __asm(" MOV R12, #0x1A");
+    __asm(" SVC #0x1A");
+}
+
+// clear flags in an event group
+// returns the flags as they were before the clear
+uint32_t clearEvents(eventHandle group, uint32_t flags)
+{
+    __asm(" MOV R12, #0x1B");
+    __asm(" SVC #0x1B");
+}
+
+// wait until any (EVENT_WAIT_ANY) or all (EVENT_WAIT_ALL) of flags are set in an event group
+// EVENT_CLEAR clears the awaited flags when the wait is satisfied
+// gives up after ticks (0 = do not block, WAIT_FOREVER = no timeout)
+// returns the flags that satisfied the wait, or 0 on a timeout
+uint32_t waitEvents(eventHandle group, uint32_t flags, uint8_t options, uint32_t ticks)
+{
+    __asm(" MOV R12, #0x1C");
+    __asm(" SVC #0x1C");
+}
+
+// send a message to a queue (the buffer pointer itself for a pointer queue)
+// waits up to ticks for room (0 = do not block, WAIT_FOREVER = no timeout)
+// returns true if the message was sent
+bool sendMessage(queueHandle queue, const void *msg, uint32_t ticks)
+{
+    __asm(" MOV R12, #0x1D");
+    __asm(" SVC #0x1D");
+}
+
+// receive a message from a queue into msg (a buffer pointer for a pointer queue)
+// waits up to ticks for a message (0 = do not block, WAIT_FOREVER = no timeout)
+// returns true if a message was received
+bool receiveMessage(queueHandle queue, void *msg, uint32_t ticks)
+{
+    __asm(" MOV R12, #0x1E");
+    __asm(" SVC #0x1E");
+}
+
+// set flags in an event group from an interrupt handler
+// the handler must run at the priority of the kernel exceptions (the default, 0), so it
+// cannot preempt a service call, systick or pendsv halfway through the kernel lists
+// a switch to a woken task is left to PendSV once the handler returns
+void setEventsFromIsr(eventHandle group, uint32_t flags)
+{
+    uint8_t i = eventGroupIndex(group);
+    if(i != NO_OBJECT)
+        eventSet(i, flags);
+}
+
+// signal a semaphore from an interrupt handler, without a service call
+// the same priority rule as setEventsFromIsr applies
+// returns false if the semaphore does not exist
+bool postFromIsr(semaphoreHandle semaphore)
+{
+    uint8_t i = semaphoreIndex(semaphore);
+    if(i != NO_OBJECT)
+        semaphorePost(i);
+    return (i != NO_OBJECT);
+}
+
+// add an item to a ring buffer from the producing interrupt handler
+// (at the kernel exception priority, as for postFromIsr)
+// wakes the consumer if it is blocked in ringWait
+// returns false if the ring is invalid, or full (the item is then counted as dropped)
+bool ringPush(ringBuffer *ring, uint32_t item)
+{
+    uint8_t i = ringIndex(ring);
+    uint32_t head;
+    if(i == NO_OBJECT)
+        return false;
+    head = ring->head;
+    if(head - ring->tail > rings[i].mask)
+    {
+        ring->dropped++;
+        return false;
+    }
+    rings[i].items[head & rings[i].mask] = item;
+    __asm(" DMB");                  // the item is stored before the new head publishes it
+    ring->head = head + 1;
+    __asm(" DMB");                  // the head is stored before the waiting flag is read
+    if(ring->waiting)
+    {
+        ring->waiting = false;
+        postFromIsr(rings[i].data);
+    }
+    return true;
+}
+
+// move up to max items out of a ring buffer into items from the consuming task
+// returns the number of items moved (0 if the ring is empty)
+uint32_t ringPop(ringBuffer *ring, uint32_t *items, uint32_t max)
+{
+    uint32_t i;
+    uint32_t tail = ring->tail;
+    uint32_t count = ring->head - tail;
+    __asm(" DMB");                  // the items are read only after the head that published them
+    if(count > max)
+        count = max;
+    for(i = 0; i < count; i++)
+        items[i] = ring->items[(tail + i) & ring->mask];
+    __asm(" DMB");                  // the items are read before their slots are handed back
+    ring->tail = tail + count;
+    return count;
+}
+
+// like ringPop, but waits up to ticks for the producer when the ring is empty
+// (WAIT_FOREVER = no timeout)
+// a wake-up that finds nothing to pop only waits out the rest of the ticks
+// returns the number of items moved (0 on timeout)
+uint32_t ringWait(ringBuffer *ring, uint32_t *items, uint32_t max, uint32_t ticks)
+{
+    uint32_t count;
+    uint32_t deadline = getTicks() + ticks;
+    uint32_t remaining = ticks;
+    while((count = ringPop(ring, items, max)) == 0)
+    {
+        if(ticks != WAIT_FOREVER)
+        {
+            uint32_t now = getTicks();
+            if(TICK_REACHED(now, deadline))
+                break;
+            remaining = deadline - now;
+        }
+        ring->waiting = true;
+        __asm(" DMB");              // the flag is stored before the head is checked again
+        if(ring->head == ring->tail && !waitTimeout(ring->data, remaining))
+        {
+            ring->waiting = false;
+            break;
+        }
+    }
+    return count;
+}
+
+// function to signal a semaphore is available using pendsv
+void post(semaphoreHandle semaphore)
+{
+    __asm(" MOV R12, #0x08");
+    __asm(" SVC #0x08");
+}
+
+// end the current job of a periodic thread and wait for the next release
+void waitPeriod(void)
+{
+    __asm(" MOV R12, #0x12");
+    __asm(" SVC #0x12");
+}
+
+// Priority Inheritance Service Call
+void pi(bool toggle)
+{
+    __asm(" MOV R12, #0x15");
+    __asm(" SVC #0x15");
+}
+
+// Time Slice Service Call
+void setTimeSlice(uint8_t priority, uint8_t ticks)
+{
+    __asm(" MOV R12, #0x14");
+    __asm(" SVC #0x14");
+}
+
+// Response Time Analysis Service Call
+void rta(void)
+{
+    __asm(" MOV R12, #0x13");
+    __asm(" SVC #0x13");
+}
+
+// Malloc From Heap SVC call
+uint32_t _malloc_from_heap(uint32_t stackBytes)
+{
+    __asm(" MOV R12, #0x09");
+    __asm(" SVC #0x09");
+}
+
+// Reboot Service Call
+void reboot()
+{
+    __asm(" MOV R12, #0x0A");
+    __asm(" SVC #0x0A");
+}
+
+// Process Status Service Call
+void ps(void)
+{
+    __asm(" MOV R12, #0x0B");
+    __asm(" SVC #0x0B");
+}
+
+// Kill Service Call
+void kill(threadHandle thread)
+{
+    __asm(" MOV R12, #0x0C");
+    __asm(" SVC #0x0C");
+}
+
+// Preemption Service Call
+void preempt(bool toggle)
+{
+    __asm(" MOV R12, #0x0D");
+    __asm(" SVC #0x0D");
+}
+
+// Pidof Service Call
+// returns the handle of the named thread, or INVALID_HANDLE
+threadHandle pidof(char* name)
+{
+    __asm(" MOV R12, #0x0F");
+    __asm(" SVC #0x0F");
+}
+
+// Tickless Idle Service Call
+void tickless(bool toggle)
+{
+    __asm(" MOV R12, #0x11");
+    __asm(" SVC #0x11");
+}
+
+// Benchmark Service Call
+void benchmark(void)
+{
+    __asm(" MOV R12, #0x10");
+    __asm(" SVC #0x10");
+}
+
+// Fetch PID (the handle of the running thread)
+threadHandle getPid()
+{
+    return runningThread;
+}
+
+// wake every sleeper whose wake tick has been reached
+// tasks blocked with a timeout are taken off their wait queue and fail the call
+void timerExpire(void)
+{
+    uint8_t task;
+    while(timerHead != NO_TASK && TICK_REACHED(tickCount, tcb[timerHead].wakeTick))
+    {
+        task = timerHead;
+        timerRemove(task);
+        if(tcb[task].timeout)
+        {
+            if(tcb[task].state == STATE_BLOCKED_MUTEX)
+                mutexQueueRemove(task);
+            else
+                waitRemove(waitQueueOf(task), task);
+            taskFrame(task)[0] = 0;             // the timed call returns false (0)
+            tcb[task].timeout = false;
+        }
+        makeReady(task);
+    }
+}
+
+// stop systick and program a one-shot wakeup for the next sleeper
+// when nothing but the idle task is ready
+void enterTickless(void)
+{
+    uint32_t ticks = MAX_TICKLESS_TICKS;
+    if(!ticklessIdle || ticklessActive || readyPriorities != PRIORITY_BIT(IDLE_PRIORITY))
+        return;
+    if(timerHead != NO_TASK)
+        ticks = tcb[timerHead].wakeTick - tickCount;
+    if(ticks < 2)
+        return;
+
+    // the next tick is due when the current systick count runs out
+    NVIC_ST_CTRL_R &= ~NVIC_ST_CTRL_ENABLE;
+    if(NVIC_INT_CTRL_R & NVIC_INT_CTRL_PENDSTSET)
+    {
+        // a tick is already pending, let it be serviced first
+        NVIC_ST_CTRL_R |= NVIC_ST_CTRL_ENABLE;
+        return;
+    }
+    ticklessResidual = NVIC_ST_CURRENT_R;
+    ticklessLoad = ticklessResidual + (ticks - 1) * CYCLES_PER_TICK;
+
+    WTIMER1_TAILR_R = ticklessLoad;
+    WTIMER1_TAV_R = 0;
+    WTIMER1_CTL_R |= TIMER_CTL_TAEN;
+    ticklessActive = true;
+}
+
+// restart systick after a tickless period and account for the ticks that were skipped
+void exitTickless(void)
+{
+    uint32_t elapsed, remaining;
+    if(!ticklessActive)
+        return;
+    WTIMER1_CTL_R &= ~TIMER_CTL_TAEN;
+    if(WTIMER1_RIS_R & TIMER_RIS_TATORIS)
+        elapsed = ticklessLoad;
+    else
+        elapsed = WTIMER1_TAV_R;
+    WTIMER1_ICR_R = TIMER_ICR_TATOCINT;
+
+    // cycles left until the next tick boundary, so the tick keeps its phase after an early wakeup
+    if(elapsed >= ticklessResidual)
+    {
+        tickCount += 1 + (elapsed - ticklessResidual) / CYCLES_PER_TICK;
+        remaining = CYCLES_PER_TICK - (elapsed - ticklessResidual) % CYCLES_PER_TICK;
+    }
+    else
+        remaining = ticklessResidual - elapsed;
+    if(remaining < 2)
+    {
+        // the boundary is due now, count it here rather than with a reload of 0
+        tickCount++;
+        remaining += CYCLES_PER_TICK;
+    }
+    timerExpire();
+
+    // run the partial tick, then put the full period back once the counter has loaded it
+    NVIC_ST_RELOAD_R = remaining - 1;
+    NVIC_ST_CURRENT_R = 0;
+    NVIC_ST_CTRL_R |= NVIC_ST_CTRL_ENABLE;
+    while(NVIC_ST_CURRENT_R == 0);
+    NVIC_ST_RELOAD_R = CYCLES_PER_TICK - 1;
+    ticklessActive = false;
+}
+
+// Wide timer 1 ends a tickless idle period
+void wideTimer1Isr(void)
+{
+    exitTickless();
+    NVIC_INT_CTRL_R |= NVIC_INT_CTRL_PEND_SV;       // enable pendsv
+}
+
+// decide at a tick whether the running task has to give up the cpu
+// a task is only switched out for a higher priority task, or for an equal one
+// once its time slice has run out
+bool tickPreempt(void)
+{
+    uint8_t prio = tcb[taskCurrent].currentPriority;
+    if(sliceLeft > 0)
+        sliceLeft--;
+    if(tcb[taskCurrent].state != STATE_READY)
+        return true;
+    if(schedPolicy == SCHED_EDF && edfHead != NO_TASK)
+        return (edfHead != taskCurrent);
+    if(schedPolicy == SCHED_RR)
+        return (sliceLeft == 0) && (tcb[taskCurrent].next != taskCurrent || readyPriorities != PRIORITY_BIT(prio));
+    if(clz(readyPriorities) < prio)
+        return true;
+    return (sliceLeft == 0) && (tcb[taskCurrent].next != taskCurrent);
+}
+
+// REQUIRED: modify this function to add support for the system timer
+// REQUIRED: in preemptive code, add code to request task switch
+void systickIsr(void)
+{
+    tickCount++;
+
+    // only the head of the timer list can be due
+    timerExpire();
+
+    pingPong++;
+
+    // change the active fill ping-pong buffer
+    if(pingPong == 1024)
+    {
+        if(recordTime)
+            recordTime = false;
+        else
+            recordTime = true;
+        pingPong = 0;
+    }
+
+    if(preemption && tickPreempt())
+        NVIC_INT_CTRL_R |= NVIC_INT_CTRL_PEND_SV;   // enable pendsv
+}
+
+// REQUIRED: in coop and preemptive, modify this function to add support for task switching
+// REQUIRED: process UNRUN and READY tasks differently
+// Task Switch:
+// called by pendSvIsr (sysregs.s) once the outgoing task's context is on its stack
+// records the outgoing stack pointer, picks the next task and returns its stack pointer
+// start is the cycle count sampled on entry to pendSvIsr
+uint32_t taskSwitch(uint32_t sp, uint32_t start)
+{
+    uint8_t taskPrevious = taskCurrent;
+    tcb[taskCurrent].sp = (void*) sp;
+
+    WTIMER0_CTL_R &= ~TIMER_CTL_TAEN;
+    tcb[taskCurrent].timeElapsed[recordTime] += WTIMER0_TAV_R;
+
+    if(((NVIC_FAULT_STAT_R & NVIC_FAULT_STAT_DERR)) || ((NVIC_FAULT_STAT_R & NVIC_FAULT_STAT_IERR)))
+    {
+        putsUart0("called from MPU\n\n");               // Print called from MPU and the clear the flags, exit.
+    }
+
+    // catch up on any ticks skipped while idle
+    exitTickless();
+
+    // start the next task with a fresh time slice
+    if(directTask != NO_TASK && tcb[directTask].state == STATE_READY)
+        taskCurrent = directTask;
+    else
+        taskCurrent = rtosScheduler();
+    directTask = NO_TASK;
+    runningThread = MAKE_HANDLE(taskCurrent, tcb[taskCurrent].generation);
+    sliceLeft = timeSlice[tcb[taskCurrent].currentPriority];
+    enterTickless();
+    if(taskCurrent != taskPrevious)
+        applySramAccessMask(tcb[taskCurrent].srd);
+
+    // track the time from a wakeup to the task running
+    if(tcb[taskCurrent].woken)
+    {
+        uint32_t latency = DWT_CYCCNT_R - tcb[taskCurrent].wakeCycles;
+        tcb[taskCurrent].wakeLatency = latency;
+        if(latency > tcb[taskCurrent].maxWakeLatency)
+            tcb[taskCurrent].maxWakeLatency = latency;
+        tcb[taskCurrent].woken = false;
+    }
+
+    // START THE TIMER FOR PS CALCULATIONS
+    WTIMER0_TAV_R = 0;
+    WTIMER0_CTL_R |= TIMER_CTL_TAEN;
+
+    benchRecord(BENCH_SWITCH, start);
+    if(svcHandoff)
+    {
+        benchRecord(BENCH_HANDOFF, handoffStart);
+        svcHandoff = false;
+    }
+    return (uint32_t) tcb[taskCurrent].sp;
+}
+
+// Service Call Handlers:
+// each handler receives the caller's exception frame (R0-R3, R12, LR, PC, xPSR)
+// arguments are read from the stacked R0-R3 and results are written back to R0
+
+// START: dispatch the first task
+void svcStart(uint32_t *frame)
+{
+    taskCurrent = rtosScheduler();
+    runningThread = MAKE_HANDLE(taskCurrent, tcb[taskCurrent].generation);
+    applySramAccessMask(tcb[taskCurrent].srd);
+    setPsp((uint32_t) tcb[taskCurrent].sp);
+    restoreTask();
+}
+
+// RESTART: rebuild the stack of a stopped thread and make it ready
+void svcRestart(uint32_t *frame)
+{
+    uint8_t i = threadIndex(frame[0]);
+    if(i != NO_OBJECT && tcb[i].state == STATE_STOPPED)
+    {
+        uint32_t size = tcb[i].size;
+        void *baseAddr = mallocFromHeap(size);
+        uint64_t srdMask = createNoSramAccessMask();
+        addSramAccessWindow(&srdMask, baseAddr, size);
+        tcb[i].srd = srdMask | tcb[i].sharedSrd;
+        tcb[i].release = tickCount;
+        tcb[i].deadline = tickCount + tcb[i].relDeadline;
+        makeReady(i);
+
+        //setting up stack
+        tcb[i].mallocated = baseAddr;
+        tcb[i].spInit = (void*)((uint32_t) baseAddr + size);
+        tcb[i].sp = initStack(tcb[i].spInit, (_fn) tcb[i].pid);
+
+        putsUart0("Restarted\n");
+    }
+    NVIC_INT_CTRL_R |= NVIC_INT_CTRL_PEND_SV; //Initiating task switching
+}
+
+// SET_PRIO: change the base priority of a thread
+void svcSetPrio(uint32_t *frame)
+{
+    uint8_t i = threadIndex(frame[0]);
+    if(i != NO_OBJECT && frame[1] < NUM_PRIORITIES && (frame[1] == IDLE_PRIORITY || !lastIdleTask(i)))
+    {
+        tcb[i].priority = frame[1];
+        updatePriority(i);
+        putsUart0("Set task Priority Successfully....\n\n");
+    }
+    NVIC_INT_CTRL_R |= NVIC_INT_CTRL_PEND_SV; //enable pendsv
+}
+
+// SLEEP_UNTIL: delay the caller until an absolute tick count
+// returns at once if the tick has already been reached
+void svcSleepUntil(uint32_t *frame)
+{
+    if(!TICK_REACHED(tickCount, frame[0]))
+    {
+        makeUnready(taskCurrent, STATE_DELAYED);
+        timerInsert(taskCurrent, frame[0]);
+        NVIC_INT_CTRL_R |= NVIC_INT_CTRL_PEND_SV;  // Enable pendsv
+    }
+}
+
+// TICKS: read the tick count
+void svcTicks(uint32_t *frame)
+{
+    frame[0] = tickCount;
+}
+
+// YIELD: give up the rest of the time slice
+void svcYield(uint32_t *frame)
+{
+    NVIC_INT_CTRL_R |= NVIC_INT_CTRL_PEND_SV;  // Enable pendsv
+}
+
+// SLEEP: delay the caller for a number of ticks
+void svcSleep(uint32_t *frame)
+{
+    makeUnready(taskCurrent, STATE_DELAYED);
+    timerInsert(taskCurrent, tickCount + frame[0]);
+    NVIC_INT_CTRL_R |= NVIC_INT_CTRL_PEND_SV;  // Enable pendsv
+}
+
+// take a mutex for the caller or block it until the mutex is handed over
+// a timed lock gives up after ticks (0 = only take the mutex if it is free)
+// the caller's R0 is set to true once it owns the mutex, or false
+void lockMutex(uint32_t *frame, bool timed, uint32_t ticks)
+{
+    uint32_t start = DWT_CYCCNT_R;
+    uint8_t mutexCurrent = mutexIndex(frame[0]);
+    frame[0] = false;
+    if(mutexCurrent == NO_OBJECT)
+        return;
+    if(!mutexes[mutexCurrent].lock)
+    {
+        tcb[taskCurrent].mutex = mutexCurrent;
+        mutexes[mutexCurrent].lock = true;
+        mutexes[mutexCurrent].lockedBy = taskCurrent;
+        // ceiling protocol: run at the ceiling for as long as the mutex is held
+        if(mutexes[mutexCurrent].ceiling < tcb[taskCurrent].currentPriority)
+            setCurrentPriority(taskCurrent, mutexes[mutexCurrent].ceiling);
+        frame[0] = true;
+    }
+    else if(!timed || ticks > 0)
+    {
+        makeUnready(taskCurrent, STATE_BLOCKED_MUTEX);
+        tcb[taskCurrent].mutex = mutexCurrent;
+        tcb[taskCurrent].blockStart = DWT_CYCCNT_R;
+        waitInsert(&mutexes[mutexCurrent].queue, taskCurrent);
+        updatePriority(mutexes[mutexCurrent].lockedBy);
+        frame[0] = true;                        // cleared by timerExpire() on a timeout
+        if(timed && ticks != WAIT_FOREVER)
+        {
+            tcb[taskCurrent].timeout = true;
+            timerInsert(taskCurrent, tickCount + ticks);
+        }
+        NVIC_INT_CTRL_R |= NVIC_INT_CTRL_PEND_SV;  // Enable pendsv
+    }
+    benchRecord(BENCH_LOCK, start);
+}
+
+// LOCK: take a mutex or block until it is handed over
+void svcLock(uint32_t *frame)
+{
+    lockMutex(frame, false, 0);
+}
+
+// LOCK_TIMEOUT: take a mutex, blocking for at most a number of ticks
+void svcLockTimeout(uint32_t *frame)
+{
+    lockMutex(frame, true, frame[1]);
+}
+
+// UNLOCK: release a mutex held by the caller
+void svcUnlock(uint32_t *frame)
+{
+    uint32_t start = DWT_CYCCNT_R;
+    uint8_t mutexCurrent = mutexIndex(frame[0]);
+    if(mutexCurrent == NO_OBJECT)
+        return;
+    if(mutexes[mutexCurrent].lock && mutexes[mutexCurrent].lockedBy == taskCurrent)
+    {
+        uint8_t next = mutexRelease(mutexCurrent);
+        updatePriority(taskCurrent);            // drop any priority inherited or taken through this mutex
+        if((next != NO_TASK && outranksCurrent(next)) || readyOutranksCurrent())
+            NVIC_INT_CTRL_R |= NVIC_INT_CTRL_PEND_SV;  // switch to the new owner, or a task the raised priority held off
+    }
+    benchRecord(BENCH_UNLOCK, start);
+}
+
+// take a semaphore count for the caller or block it until one is posted
+// a timed wait gives up after ticks (0 = only take a count that is available)
+// the caller's R0 is set to true once it has the count, or false
+void waitSemaphore(uint32_t *frame, bool timed, uint32_t ticks)
+{
+    uint8_t semaphoreCurrent = semaphoreIndex(frame[0]);
+    frame[0] = false;
+    if(semaphoreCurrent == NO_OBJECT)
+        return;
+    if(semaphores[semaphoreCurrent].count > 0)
+    {
+        semaphores[semaphoreCurrent].count--;
+        frame[0] = true;
+    }
+    else if(!timed || ticks > 0)
+    {
+        tcb[taskCurrent].semaphore = semaphoreCurrent;
+        waitInsert(&semaphores[semaphoreCurrent].queue, taskCurrent);
+        makeUnready(taskCurrent, STATE_BLOCKED_SEMAPHORE);
+        frame[0] = true;                        // cleared by timerExpire() on a timeout
+        if(timed && ticks != WAIT_FOREVER)
+        {
+            tcb[taskCurrent].timeout = true;
+            timerInsert(taskCurrent, tickCount + ticks);
+        }
+        NVIC_INT_CTRL_R |= NVIC_INT_CTRL_PEND_SV;  // Enable pendsv
+    }
+}
+
+// WAIT: take a semaphore count or block until one is posted
+void svcWait(uint32_t *frame)
+{
+    waitSemaphore(frame, false, 0);
+}
+
+// WAIT_TIMEOUT: take a semaphore count, blocking for at most a number of ticks
+void svcWaitTimeout(uint32_t *frame)
+{
+    waitSemaphore(frame, true, frame[1]);
+}
+
+// POST: add a semaphore count or wake the first waiter
+void svcPost(uint32_t *frame)
+{
+    uint8_t semaphoreCurrent = semaphoreIndex(frame[0]);
+    if(semaphoreCurrent != NO_OBJECT)
+        semaphorePost(semaphoreCurrent);
+}
+
+// MALLOC: allocate heap memory to the caller
+void svcMalloc(uint32_t *frame)
+{
+    uint64_t srdMask = 0;
+    uint32_t size = frame[0];
+    void* allocatedAddr = mallocFromHeap(size);
+    addSramAccessWindow(&srdMask, allocatedAddr, size);
+    applySramAccessMask(srdMask);
+    frame[0] = (uint32_t) allocatedAddr;
+}
+
+// REBOOT: reset the system
+void svcReboot(uint32_t *frame)
+{
+    putsUart0("Rebooted Successfully....\n\n");
+    putsUart0("Welcome to the TIVA C RTOS Environment\n\n");
+    putsUart0("\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\n");
+    NVIC_APINT_R = NVIC_APINT_VECTKEY | NVIC_APINT_SYSRESETREQ;
+}
+
+// PS: process status (not implemented yet)
+void svcPs(uint32_t *frame)
+{
+}
+
+// KILL: stop a thread and free its resources
+void svcKill(uint32_t *frame)
+{
+    uint32_t killPid = frame[0];
+    uint8_t i = threadIndex(killPid);
+    uint8_t j;
+    if(i != NO_OBJECT && lastIdleTask(i))
+    {
+        putsUart0("\nThe last idle priority thread cannot be killed\n");
+        return;
+    }
+    if(i != NO_OBJECT && tcb[i].state != STATE_STOPPED)
+    {
+        for(j = 0; j < MAX_MUTEXES; j++)                    // release any mutex the task holds
+        {
+            if(mutexes[j].lock && mutexes[j].lockedBy == i)
+                mutexRelease(j);
+            else if(mutexes[j].slot.used && mutexes[j].word != 0
+                    && (*mutexes[j].word & FAST_OWNER_M) == MAKE_HANDLE(i, tcb[i].generation))
+                *mutexes[j].word = 0;                       // a fast mutex held without waiters
+        }
+        for(j = 0; j < MAX_RWLOCKS; j++)                    // release any reader-writer lock the task holds
+        {
+            if(rwlocks[j].slot.used && rwlocks[j].writer == i)
+                rwWriteRelease(j);
+            else if(tcb[i].rwReading & (1 << j))
+                rwReadRelease(j, i);
+        }
+        if(tcb[i].state == STATE_BLOCKED_MUTEX)             // if the task to kill is blocked by a mutex
+            mutexQueueRemove(i);
+        else if(tcb[i].state == STATE_BLOCKED_SEMAPHORE)    // if the task is blocked by a semaphore
+            semaphoreQueueRemove(i);
+        else if(tcb[i].state == STATE_BLOCKED_EVENT)        // if the task is blocked by an event group
+            waitRemove(&eventGroups[tcb[i].eventGroup].queue, i);
+        else if(tcb[i].state == STATE_BLOCKED_QUEUE)        // if the task is blocked by a message queue
+            waitRemove(waitQueueOf(i), i);
+        else if(tcb[i].state == STATE_BLOCKED_CALL)         // if the task is waiting to call a server
+            waitRemove(waitQueueOf(i), i);
+        else if(tcb[i].state == STATE_BLOCKED_CONDITION)    // if the task is waiting on a condition variable
+            waitRemove(waitQueueOf(i), i);
+        else if(tcb[i].state == STATE_BLOCKED_RWLOCK)       // if the task is blocked by a reader-writer lock
+        {
+            waitRemove(waitQueueOf(i), i);
+            if(rwlocks[tcb[i].rwlock].writer != NO_TASK)
+                updatePriority(rwlocks[tcb[i].rwlock].writer);
+            else if(tcb[i].rwWrite)
+            {
+                rwReadersUpdate(tcb[i].rwlock);     // drop what the readers inherited from this writer
+                if(rwlocks[tcb[i].rwlock].readers > 0 && rwlocks[tcb[i].rwlock].writeQueue.head == NO_TASK)
+                    rwGrant(tcb[i].rwlock);         // readers held back for this writer can enter
+            }
+        }
+        ipcAbort(i);                                        // fail the calls made to the task
+        if(tcb[i].state == STATE_DELAYED)                   // if the task is sleeping
+            timerRemove(i);
+        timeoutCancel(i);
+        freeToHeap(tcb[i].mallocated);
+        // update the tcb for the task
+        tcb[i].mutex      = 0;
+        tcb[i].semaphore  = 0;
+        tcb[i].wakeTick   = 0;
+        makeUnready(i, STATE_STOPPED);
+        setCurrentPriority(i, tcb[i].priority);
+    }
+    char str[20] = {0,};
+    putsUart0("\nKilled :\t");
+    print(killPid, str, 10);
+    NVIC_INT_CTRL_R |= NVIC_INT_CTRL_PEND_SV;  // Enable pendsv
+}
+
+// PREEMPT: select preemptive or cooperative switching
+void svcPreempt(uint32_t *frame)
+{
+    bool preempt = frame[0];
+    if(preempt)
+    {
+        preemption = true;
+        putsUart0("Preemption turned ON\n");
+    }
+    else
+    {
+        preemption = false;
+        putsUart0("Preemption turn OFF\n");
+    }
+}
+
+// SCHED: select the scheduling policy
+void svcSched(uint32_t *frame)
+{
+    uint8_t sched = frame[0];
+    if(sched == SCHED_PRIO)
+    {
+        schedPolicy = SCHED_PRIO;
+        putsUart0("Priority Scheduling is now selected\n");
+    }
+    else if(sched == SCHED_EDF)
+    {
+        schedPolicy = SCHED_EDF;
+        putsUart0("Earliest Deadline First Scheduling is now selected\n");
+    }
+    else
+    {
+        schedPolicy = SCHED_RR;
+        putsUart0("Round Robin Scheduling is now selected\n");
+    }
+    NVIC_INT_CTRL_R |= NVIC_INT_CTRL_PEND_SV;  // Enable pendsv
+}
+
+// PIDOF: look up the handle of a thread by name
+void svcPidof(uint32_t *frame)
+{
+    uint8_t proc;
+    threadHandle pid = INVALID_HANDLE;
+    char* process = (char*) frame[0];
+    for(proc = 0; proc < MAX_TASKS; proc++)
+    {
+        if(tcb[proc].state != STATE_INVALID && stringCmp(tcb[proc].name, process) == 0)
+        {
+            pid = MAKE_HANDLE(proc, tcb[proc].generation);
+            break;
+        }
+    }
+    frame[0] = pid;
+}
+
+// BENCH: print the kernel benchmarks
+void svcBench(uint32_t *frame)
+{
+    uint8_t i;
+    char str[12];
+    putsUart0("Path\tLast\tMax (cycles)\n");
+    for(i = 0; i < BENCH_COUNT; i++)
+    {
+        putsUart0((char*) benchName[i]);
+        putsUart0("\t");
+        putsUart0(itoa(bench[i].last, str, 10));
+        putsUart0("\t");
+        putsUart0(itoa(bench[i].max, str, 10));
+        putsUart0("\n");
+    }
+    putsUart0("Task\t\tBlocked\tWake\tWake max (cycles)\n");
+    for(i = 0; i < MAX_TASKS; i++)
+    {
+        if(tcb[i].state == STATE_INVALID || (tcb[i].maxBlocked == 0 && tcb[i].maxWakeLatency == 0))
+            continue;
+        putsUart0(tcb[i].name);
+        putsUart0("\t\t");
+        putsUart0(itoa(tcb[i].maxBlocked, str, 10));
+        putsUart0("\t");
+        putsUart0(itoa(tcb[i].wakeLatency, str, 10));
+        putsUart0("\t");
+        putsUart0(itoa(tcb[i].maxWakeLatency, str, 10));
+        putsUart0("\n");
+    }
+}
+
+// TICKLESS: turn tickless idle on or off
+void svcTickless(uint32_t *frame)
+{
+    bool tickless = frame[0];
+    if(tickless)
+    {
+        ticklessIdle = true;
+        putsUart0("Tickless idle turned ON\n");
+    }
+    else
+    {
+        ticklessIdle = false;
+        putsUart0("Tickless idle turned OFF\n");
+    }
+}
+
+// PERIOD: end the current job of a periodic thread
+void svcPeriod(uint32_t *frame)
+{
+    uint8_t task = taskCurrent;
+    if(tcb[task].period)
+    {
+        if(!TICK_REACHED(tcb[task].deadline, tickCount))
+            tcb[task].deadlineMisses++;
+
+        // release the next job when its period starts (immediately on overrun)
+        readyRemove(task);
+        tcb[task].release += tcb[task].period;
+        tcb[task].deadline = tcb[task].release + tcb[task].relDeadline;
+        readyInsert(task);
+        if(!TICK_REACHED(tickCount, tcb[task].release))
+        {
+            makeUnready(task, STATE_DELAYED);
+            timerInsert(task, tcb[task].release);
+        }
+    }
+    NVIC_INT_CTRL_R |= NVIC_INT_CTRL_PEND_SV;  // Enable pendsv
+}
+
+// RTA: print the response time analysis of the periodic threads
+void svcRta(uint32_t *frame)
+{
+    uint8_t i;
+    char str[12];
+    bool ok = admissionTest();
+    putsUart0("Name\t\tC\tT\tD\tR\tMisses\n");
+    for(i = 0; i < MAX_TASKS; i++)
+    {
+        if(tcb[i].state == STATE_INVALID || tcb[i].period == 0)
+            continue;
+        putsUart0(tcb[i].name);
+        putsUart0("\t\t");
+        putsUart0(itoa(tcb[i].wcet, str, 10));
+        putsUart0("\t");
+        putsUart0(itoa(tcb[i].period, str, 10));
+        putsUart0("\t");
+        putsUart0(itoa(tcb[i].relDeadline, str, 10));
+        putsUart0("\t");
+        if(tcb[i].wcet == 0)
+            putsUart0("-");
+        else if(tcb[i].responseTime > tcb[i].relDeadline)
+            putsUart0("miss");
+        else
+            putsUart0(itoa(tcb[i].responseTime, str, 10));
+        putsUart0("\t");
+        putsUart0(itoa(tcb[i].deadlineMisses, str, 10));
+        putsUart0("\n");
+    }
+    if(ok)
+        putsUart0("Task set is schedulable\n");
+    else
+        putsUart0("Task set is NOT schedulable\n");
+}
+
+// SLICE: set the round-robin time slice of a priority level
+void svcSlice(uint32_t *frame)
+{
+    uint8_t priority = frame[0];
+    uint8_t ticks = frame[1];
+    if(priority < NUM_PRIORITIES && ticks > 0)
+    {
+        timeSlice[priority] = ticks;
+        putsUart0("Time slice set\n");
+    }
+    else
+        putsUart0("Invalid time slice\n");
+}
+
+// PI: turn priority inheritance on or off
+void svcPi(uint32_t *frame)
+{
+    bool pi = frame[0];
+    uint8_t i;
+    priorityInheritance = pi;
+    if(pi)
+        putsUart0("Priority Inheritance turned ON\n");
+    else
+        putsUart0("Priority Inheritance turned OFF\n");
+
+    // apply the new setting to current mutex owners and restart the blocking measurements
+    for(i = 0; i < MAX_MUTEXES; i++)
+    {
+        if(mutexes[i].lock)
+            updatePriority(mutexes[i].lockedBy);
+    }
+    for(i = 0; i < MAX_TASKS; i++)
+        tcb[i].maxBlocked = 0;
+    NVIC_INT_CTRL_R |= NVIC_INT_CTRL_PEND_SV;  // Enable pendsv
+}
+
+// SET_EVENTS: set flags in an event group, returns the flags after any waiters were woken
+void svcSetEvents(uint32_t *frame)
+{
+    uint8_t group = eventGroupIndex(frame[0]);
+    if(group == NO_OBJECT)
+    {
+        frame[0] = 0;
+        return;
+    }
+    eventSet(group, frame[1]);
+    frame[0] = eventGroups[group].flags;
+}
+
+// CLEAR_EVENTS: clear flags in an event group, returns the flags before they were cleared
+void svcClearEvents(uint32_t *frame)
+{
+    uint8_t group = eventGroupIndex(frame[0]);
+    if(group == NO_OBJECT)
+    {
+        frame[0] = 0;
+        return;
+    }
+    frame[0] = eventGroups[group].flags;
+    eventGroups[group].flags &= ~frame[1];
+}
+
+// WAIT_EVENTS: wait until any or all of a set of flags are set in an event group
+// returns the flags that satisfied the wait, or 0 on a timeout or a bad handle
+void svcWaitEvents(uint32_t *frame)
+{
+    uint8_t group = eventGroupIndex(frame[0]);
+    uint32_t mask = frame[1];
+    uint8_t options = frame[2];
+    uint32_t ticks = frame[3];
+    frame[0] = 0;
+    if(group == NO_OBJECT || mask == 0)
+        return;
+    if(eventMatch(eventGroups[group].flags, mask, options))
+    {
+        frame[0] = eventGroups[group].flags;
+        if(options & EVENT_CLEAR)
+            eventGroups[group].flags &= ~mask;
+    }
+    else if(ticks > 0)
+    {
+        tcb[taskCurrent].eventGroup = group;
+        tcb[taskCurrent].eventMask = mask;
+        tcb[taskCurrent].eventOptions = options;
+        waitInsert(&eventGroups[group].queue, taskCurrent);
+        makeUnready(taskCurrent, STATE_BLOCKED_EVENT);
+        if(ticks != WAIT_FOREVER)
+        {
+            tcb[taskCurrent].timeout = true;
+            timerInsert(taskCurrent, tickCount + ticks);
+        }
+        NVIC_INT_CTRL_R |= NVIC_INT_CTRL_PEND_SV;  // Enable pendsv
+    }
+}
+
+// SEND: send a message, waiting for room for at most a number of ticks
+// a waiting receiver gets the message directly, without it passing through the storage
+// returns true once the message is queued or delivered
+void svcSend(uint32_t *frame)
+{
+    uint8_t i = msgQueueIndex(frame[0]);
+    uint32_t ticks = frame[2];
+    void *msg;
+    msgQueue *queue;
+    frame[0] = false;
+    if(i == NO_OBJECT)
+        return;
+    queue = &msgQueues[i];
+    // the message is the data R1 points to, or the pointer in R1 itself for a pointer queue
+    msg = (queue->itemSize == 0) ? (void*) &frame[1] : (void*) frame[1];
+    if(queue->receivers.head != NO_TASK)
+    {
+        uint8_t task = queue->receivers.head;
+        msgCopy(queue, tcb[task].msgBuffer, msg);
+        msgWake(&queue->receivers, task);
+        frame[0] = true;
+    }
+    else if(queue->count < queue->depth)
+    {
+        msgCopy(queue, msgSlot(queue, queue->head + queue->count), msg);
+        queue->count++;
+        frame[0] = true;
+    }
+    else if(ticks > 0)
+    {
+        frame[0] = true;                        // cleared by timerExpire() on a timeout
+        msgBlock(i, true, msg, ticks);          // the message stays in the sender's frame or buffer
+    }
+}
+
+// RECEIVE: receive a message, waiting for one for at most a number of ticks
+// a waiting sender's message takes the freed slot directly
+// returns true once a message has been received
+void svcReceive(uint32_t *frame)
+{
+    uint8_t i = msgQueueIndex(frame[0]);
+    void *buffer = (void*) frame[1];
+    uint32_t ticks = frame[2];
+    msgQueue *queue;
+    frame[0] = false;
+    if(i == NO_OBJECT)
+        return;
+    queue = &msgQueues[i];
+    if(queue->count > 0)
+    {
+        msgCopy(queue, buffer, msgSlot(queue, queue->head));
+        queue->head = (queue->head + 1 == queue->depth) ? 0 : queue->head + 1;
+        queue->count--;
+        if(queue->senders.head != NO_TASK)
+        {
+            uint8_t task = queue->senders.head;
+            msgCopy(queue, msgSlot(queue, queue->head + queue->count), tcb[task].msgBuffer);
+            queue->count++;
+            msgWake(&queue->senders, task);
+        }
+        frame[0] = true;
+    }
+    else if(ticks > 0)
+    {
+        frame[0] = true;                        // cleared by timerExpire() on a timeout
+        msgBlock(i, false, buffer, ticks);
+    }
+}
+
+// CALL: send a request (R0-R3) to the server named in R12 and wait for its reply
+// a server already waiting in replyWait() is handed the request and run at once
+void svcCall(uint32_t *frame)
+{
+    uint8_t server = threadIndex(frame[4] >> 8);
+    frame[4] = CALL;                            // no partner until the server replies
+    if(server == NO_OBJECT || server == taskCurrent || tcb[server].state == STATE_STOPPED)
+        return;
+    tcb[taskCurrent].ipcServer = server;
+    if(tcb[server].state == STATE_BLOCKED_RECEIVE)
+    {
+        ipcCopy(taskFrame(server), frame, taskCurrent, REPLY_WAIT);
+        makeUnready(taskCurrent, STATE_BLOCKED_REPLY);
+        makeReady(server);
+        switchDirect(server);
+    }
+    else
+    {
+        makeUnready(taskCurrent, STATE_BLOCKED_CALL);
+        waitInsert(&tcb[server].callers, taskCurrent);
+        NVIC_INT_CTRL_R |= NVIC_INT_CTRL_PEND_SV;  // Enable pendsv
+    }
+}
+
+// REPLY_WAIT: reply (R0-R3) to the client named in R12, then take the next request
+// the request and its client are returned in R0-R3 and R12
+// with no request waiting, the server blocks and the client it replied to runs at once
+void svcReplyWait(uint32_t *frame)
+{
+    uint8_t client = threadIndex(frame[4] >> 8);
+    uint8_t replied = NO_TASK;
+    uint8_t next;
+    if(client != NO_OBJECT && tcb[client].state == STATE_BLOCKED_REPLY && tcb[client].ipcServer == taskCurrent)
+    {
+        ipcCopy(taskFrame(client), frame, taskCurrent, CALL);
+        makeReady(client);
+        replied = client;
+    }
+    next = waitPop(&tcb[taskCurrent].callers);
+    if(next != NO_TASK)
+    {
+        ipcCopy(frame, taskFrame(next), next, REPLY_WAIT);
+        tcb[next].state = STATE_BLOCKED_REPLY;
+        if(replied != NO_TASK && outranksCurrent(replied))
+            NVIC_INT_CTRL_R |= NVIC_INT_CTRL_PEND_SV;  // switch to the client now
+    }
+    else
+    {
+        makeUnready(taskCurrent, STATE_BLOCKED_RECEIVE);
+        if(replied != NO_TASK)
+            switchDirect(replied);
+        else
+            NVIC_INT_CTRL_R |= NVIC_INT_CTRL_PEND_SV;  // Enable pendsv
+    }
+}
+
+// FAST_LOCK: block on a fast mutex that fastTryLock() found locked
+// the owner is recorded in the kernel mutex so the waiters' priority is inherited
+void svcFastLock(uint32_t *frame)
+{
+    uint32_t start = DWT_CYCCNT_R;
+    fastMutex *fast = (fastMutex*) frame[0];
+    uint8_t mutexCurrent = mutexIndex(fast->mutex);
+    uint8_t owner;
+    if(mutexCurrent == NO_OBJECT || mutexes[mutexCurrent].word != &fast->owner)
+        return;
+    owner = threadIndex(fast->owner & FAST_OWNER_M);
+    if(owner == NO_OBJECT || tcb[owner].state == STATE_STOPPED)
+    {
+        // unlocked since the attempt, or the owner was killed
+        fast->owner = runningThread;
+        return;
+    }
+    fast->owner |= FAST_WAITERS;                // send the owner's unlock to the kernel
+    mutexes[mutexCurrent].lock = true;
+    mutexes[mutexCurrent].lockedBy = owner;
+    makeUnready(taskCurrent, STATE_BLOCKED_MUTEX);
+    tcb[taskCurrent].mutex = mutexCurrent;
+    tcb[taskCurrent].blockStart = DWT_CYCCNT_R;
+    waitInsert(&mutexes[mutexCurrent].queue, taskCurrent);
+    updatePriority(owner);
+    NVIC_INT_CTRL_R |= NVIC_INT_CTRL_PEND_SV;  // Enable pendsv
+    benchRecord(BENCH_LOCK, start);
+}
+
+// FAST_UNLOCK: hand a fast mutex with waiters to the first of them
+void svcFastUnlock(uint32_t *frame)
+{
+    uint32_t start = DWT_CYCCNT_R;
+    fastMutex *fast = (fastMutex*) frame[0];
+    uint8_t mutexCurrent = mutexIndex(fast->mutex);
+    uint8_t next;
+    if(mutexCurrent == NO_OBJECT || mutexes[mutexCurrent].word != &fast->owner
+            || (fast->owner & FAST_OWNER_M) != runningThread)
+        return;
+    if(mutexes[mutexCurrent].lock)
+    {
+        next = mutexRelease(mutexCurrent);
+        updatePriority(taskCurrent);            // drop any priority inherited through this mutex
+        if((next != NO_TASK && outranksCurrent(next)) || readyOutranksCurrent())
+            NVIC_INT_CTRL_R |= NVIC_INT_CTRL_PEND_SV;  // switch to the new owner, or a task the raised priority held off
+    }
+    else
+        fast->owner = 0;
+    benchRecord(BENCH_UNLOCK, start);
+}
+
+// COND_WAIT: unlock a mutex and wait on a condition variable in one step
+// returns true once the task has been signalled and owns the mutex again, false if
+// a handle is bad or the caller does not hold the mutex
+void svcCondWait(uint32_t *frame)
+{
+    uint8_t cv = conditionIndex(frame[0]);
+    uint8_t mutexCurrent = mutexIndex(frame[1]);
+    frame[0] = false;
+    if(cv == NO_OBJECT || mutexCurrent == NO_OBJECT || mutexes[mutexCurrent].word != 0
+            || !mutexes[mutexCurrent].lock || mutexes[mutexCurrent].lockedBy != taskCurrent)
+        return;
+    mutexRelease(mutexCurrent);
+    updatePriority(taskCurrent);                // drop any priority inherited or taken through the mutex
+    tcb[taskCurrent].mutex = mutexCurrent;
+    tcb[taskCurrent].condition = cv;
+    makeUnready(taskCurrent, STATE_BLOCKED_CONDITION);
+    waitInsert(&conditions[cv].queue, taskCurrent);
+    frame[0] = true;
+    NVIC_INT_CTRL_R |= NVIC_INT_CTRL_PEND_SV;  // Enable pendsv
+}
+
+// COND_SIGNAL: move the first task waiting on a condition variable to its mutex
+void svcCondSignal(uint32_t *frame)
+{
+    uint8_t cv = conditionIndex(frame[0]);
+    uint8_t task;
+    if(cv == NO_OBJECT)
+        return;
+    task = waitPop(&conditions[cv].queue);
+    if(task != NO_TASK)
+        conditionMove(task);
+}
+
+// COND_BROADCAST: move every task waiting on a condition variable to its mutex
+void svcCondBroadcast(uint32_t *frame)
+{
+    uint8_t cv = conditionIndex(frame[0]);
+    uint8_t task;
+    if(cv == NO_OBJECT)
+        return;
+    while((task = waitPop(&conditions[cv].queue)) != NO_TASK)
+        conditionMove(task);
+}
+
+// READ_LOCK: lock a reader-writer lock for reading
+// readers share the lock, but wait while a writer holds it or is waiting for it
+void svcReadLock(uint32_t *frame)
+{
+    uint8_t lock = rwlockIndex(frame[0]);
+    if(lock == NO_OBJECT || (tcb[taskCurrent].rwReading & (1 << lock)) || rwlocks[lock].writer == taskCurrent)
+        return;
+    if(rwlocks[lock].writer == NO_TASK && rwlocks[lock].writeQueue.head == NO_TASK)
+    {
+        rwlocks[lock].readers++;
+        tcb[taskCurrent].rwReading |= 1 << lock;
+    }
+    else
+        rwBlock(lock, false);
+}
+
+// READ_UNLOCK: release a reader-writer lock held for reading
+void svcReadUnlock(uint32_t *frame)
+{
+    uint8_t lock = rwlockIndex(frame[0]);
+    if(lock != NO_OBJECT && (tcb[taskCurrent].rwReading & (1 << lock)))
+        rwReadRelease(lock, taskCurrent);
+}
+
+// WRITE_LOCK: lock a reader-writer lock for writing, once the readers have left
+void svcWriteLock(uint32_t *frame)
+{
+    uint8_t lock = rwlockIndex(frame[0]);
+    if(lock == NO_OBJECT || (tcb[taskCurrent].rwReading & (1 << lock)) || rwlocks[lock].writer == taskCurrent)
+        return;
+    if(rwlocks[lock].writer == NO_TASK && rwlocks[lock].readers == 0)
+        rwlocks[lock].writer = taskCurrent;
+    else
+        rwBlock(lock, true);
+}
+
+// WRITE_UNLOCK: release a reader-writer lock held for writing
+void svcWriteUnlock(uint32_t *frame)
+{
+    uint8_t lock = rwlockIndex(frame[0]);
+    if(lock != NO_OBJECT && rwlocks[lock].writer == taskCurrent)
+        rwWriteRelease(lock);
+}
+
+// CREATE_MUTEX: create a mutex with a ceiling priority or NO_CEILING
+void svcCreateMutex(uint32_t *frame)
+{
+    frame[0] = mutexCreate(frame[0]);
+}
+
+// DELETE_MUTEX: return a mutex to the pool
+void svcDeleteMutex(uint32_t *frame)
+{
+    frame[0] = mutexDelete(frame[0]);
+}
+
+// INIT_FAST: set up a fast mutex
+void svcInitFast(uint32_t *frame)
+{
+    frame[0] = fastMutexInit((fastMutex*) frame[0]);
+}
+
+// DELETE_FAST: return the kernel mutex of a fast mutex to the pool
+void svcDeleteFast(uint32_t *frame)
+{
+    frame[0] = fastMutexDelete((fastMutex*) frame[0]);
+}
+
+// CREATE_SEMAPHORE: create a semaphore with an initial count
+void svcCreateSemaphore(uint32_t *frame)
+{
+    frame[0] = semaphoreCreate(frame[0]);
+}
+
+// DELETE_SEMAPHORE: return a semaphore to the pool
+void svcDeleteSemaphore(uint32_t *frame)
+{
+    frame[0] = semaphoreDelete(frame[0]);
+}
+
+// MUTEX_ORDER: select the wakeup order of a mutex
+void svcMutexOrder(uint32_t *frame)
+{
+    frame[0] = mutexQueueOrder(frame[0], frame[1]);
+}
+
+// SEMAPHORE_ORDER: select the wakeup order of a semaphore
+void svcSemaphoreOrder(uint32_t *frame)
+{
+    frame[0] = semaphoreQueueOrder(frame[0], frame[1]);
+}
+
+// CREATE_EVENTS: create an event group
+void svcCreateEvents(uint32_t *frame)
+{
+    frame[0] = eventGroupCreate();
+}
+
+// DELETE_EVENTS: return an event group to the pool
+void svcDeleteEvents(uint32_t *frame)
+{
+    frame[0] = eventGroupDelete(frame[0]);
+}
+
+// CREATE_QUEUE: create a message queue (frame[1] = item size, 0 for a pointer queue)
+void svcCreateQueue(uint32_t *frame)
+{
+    frame[0] = msgQueueCreate((void*) frame[0], frame[1], frame[2]);
+}
+
+// DELETE_QUEUE: return a message queue to the pool
+void svcDeleteQueue(uint32_t *frame)
+{
+    frame[0] = msgQueueDelete(frame[0]);
+}
+
+// CREATE_COND: create a condition variable
+void svcCreateCond(uint32_t *frame)
+{
+    frame[0] = conditionCreate();
+}
+
+// DELETE_COND: return a condition variable to the pool
+void svcDeleteCond(uint32_t *frame)
+{
+    frame[0] = conditionDelete(frame[0]);
+}
+
+// CREATE_RWLOCK: create a reader-writer lock
+void svcCreateRwLock(uint32_t *frame)
+{
+    frame[0] = rwlockCreate();
+}
+
+// DELETE_RWLOCK: return a reader-writer lock to the pool
+void svcDeleteRwLock(uint32_t *frame)
+{
+    frame[0] = rwlockDelete(frame[0]);
+}
+
+// CREATE_RING: create a ring buffer for a consumer thread
+void svcCreateRing(uint32_t *frame)
+{
+    frame[0] = (uint32_t) ringCreate(frame[0], frame[1]);
+}
+
+// DELETE_RING: free a ring buffer
+void svcDeleteRing(uint32_t *frame)
+{
+    frame[0] = ringDelete((ringBuffer*) frame[0]);
+}
+
+// service call table, indexed by the service call number
+const _svc svcTable[SVC_COUNT] =
+{
+    svcStart,                   // START
+    svcRestart,                 // RESTART
+    svcSetPrio,                 // SET_PRIO
+    svcYield,                   // YIELD
+    svcSleep,                   // SLEEP
+    svcLock,                    // LOCK
+    svcUnlock,                  // UNLOCK
+    svcWait,                    // WAIT
+    svcPost,                    // POST
+    svcMalloc,                  // MALLOC
+    svcReboot,                  // REBOOT
+    svcPs,                      // PS
+    svcKill,                    // KILL
+    svcPreempt,                 // PREEMPT
+    svcSched,                   // SCHED
+    svcPidof,                   // PIDOF
+    svcBench,                   // BENCH
+    svcTickless,                // TICKLESS
+    svcPeriod,                  // PERIOD
+    svcRta,                     // RTA
+    svcSlice,                   // SLICE
+    svcPi,                      // PI
+    svcLockTimeout,             // LOCK_TIMEOUT
+    svcWaitTimeout,             // WAIT_TIMEOUT
+    svcSleepUntil,              // SLEEP_UNTIL
+    svcTicks,                   // TICKS
+    svcSetEvents,               // SET_EVENTS
+    svcClearEvents,             // CLEAR_EVENTS
+    svcWaitEvents,              // WAIT_EVENTS
+    svcSend,                    // SEND
+    svcReceive,                 // RECEIVE
+    svcCall,                    // CALL
+    svcReplyWait,               // REPLY_WAIT
+    svcFastLock,                // FAST_LOCK
+    svcFastUnlock,              // FAST_UNLOCK
+    svcCondWait,                // COND_WAIT
+    svcCondSignal,              // COND_SIGNAL
+    svcCondBroadcast,           // COND_BROADCAST
+    svcReadLock,                // READ_LOCK
+    svcReadUnlock,              // READ_UNLOCK
+    svcWriteLock,               // WRITE_LOCK
+    svcWriteUnlock,             // WRITE_UNLOCK
+    svcCreateMutex,             // CREATE_MUTEX
+    svcDeleteMutex,             // DELETE_MUTEX
+    svcInitFast,                // INIT_FAST
+    svcCreateSemaphore,         // CREATE_SEMAPHORE
+    svcDeleteSemaphore,         // DELETE_SEMAPHORE
+    svcMutexOrder,              // MUTEX_ORDER
+    svcSemaphoreOrder,          // SEMAPHORE_ORDER
+    svcCreateEvents,            // CREATE_EVENTS
+    svcDeleteEvents,            // DELETE_EVENTS
+    svcCreateQueue,             // CREATE_QUEUE
+    svcDeleteQueue,             // DELETE_QUEUE
+    svcCreateCond,              // CREATE_COND
+    svcDeleteCond,              // DELETE_COND
+    svcCreateRwLock,            // CREATE_RWLOCK
+    svcDeleteRwLock,            // DELETE_RWLOCK
+    svcCreateRing,              // CREATE_RING
+    svcDeleteFast,              // DELETE_FAST
+    svcDeleteRing,              // DELETE_RING
+};
+
+// REQUIRED: modify this function to add support for the service call
+// REQUIRED: in preemptive code, add code to handle synchronization primitives
+// called by svCallIsr (sysregs.s) with the caller's exception frame
+// the service call number is passed in the low byte of R12, arguments in R0-R3
+// (call() and replyWait() pass a thread handle in the upper bits of R12)
+// start is the cycle count sampled on entry to svCallIsr
+// returns 1 when the caller blocked or gave up the cpu, in which case svCallIsr
+// switches tasks in this exception instead of taking a separate PendSV exception
+uint32_t svCallHandler(uint32_t *frame, uint32_t start)
+{
+    uint32_t svcNo = frame[4] & SVC_NUMBER_M;
+    if(svcNo < SVC_COUNT)
+        svcTable[svcNo](frame);
+
+    if(NVIC_INT_CTRL_R & NVIC_INT_CTRL_PEND_SV)
+    {
+        NVIC_INT_CTRL_R = NVIC_INT_CTRL_UNPEND_SV;
+        svcHandoff = true;
+        handoffStart = start;
+        return 1;
+    }
+    return 0;
 }
@@ -29,53 +29,155 @@
 // function pointer
 typedef void (*_fn)();
 
-// mutex
-#define MAX_MUTEXES 1
-#define MAX_MUTEX_QUEUE_SIZE 2
-#define resource 0
-
-// semaphore
-#define MAX_SEMAPHORES 3
-#define MAX_SEMAPHORE_QUEUE_SIZE 2
-#define keyPressed 0
-#define keyReleased 1
-#define flashReq 2
+// kernel object pools
+#define MAX_MUTEXES 16
+#define MAX_SEMAPHORES 16
+#define MAX_EVENT_GROUPS 8
+#define MAX_QUEUES 8
+#define MAX_CONDITIONS 8
+#define MAX_RWLOCKS 8           // at most 8 (one bit per lock in the tcb)
+#define MAX_RINGS 4
+
+// handles to kernel objects (0 is never a valid handle)
+typedef uint16_t mutexHandle;
+typedef uint16_t semaphoreHandle;
+typedef uint16_t threadHandle;
+typedef uint16_t eventHandle;
+typedef uint16_t queueHandle;
+typedef uint16_t condHandle;
+typedef uint16_t rwlockHandle;
+#define INVALID_HANDLE 0
+
+// fast mutex: locked and unlocked by the task itself unless it is contended
+typedef struct _fastMutex
+{
+    volatile uint32_t owner;    // handle of the owning thread (0 = unlocked)
+    mutexHandle mutex;          // kernel mutex that contended tasks block on
+} fastMutex;
+
+// single-producer/single-consumer ring of 32-bit items, filled by an interrupt handler
+// and drained by one task without service calls
+// the consumer can write this block, so the producer uses the kernel's own copy of
+// mask, items and data (found through handle) and never the fields below
+typedef struct _ringBuffer
+{
+    volatile uint32_t head;     // items pushed (written only by the producer)
+    volatile uint32_t tail;     // items popped (written only by the consumer)
+    uint32_t mask;              // capacity - 1 (the capacity is a power of two)
+    volatile uint32_t dropped;  // items pushed while the ring was full
+    volatile bool waiting;      // the consumer is about to block on data
+    uint16_t handle;            // kernel descriptor of the ring
+    semaphoreHandle data;       // posted by the producer to wake a waiting consumer
+    uint32_t *items;            // storage, in the same heap block as the ring
+} ringBuffer;
+
+// timeout that never expires
+#define WAIT_FOREVER 0xFFFFFFFF
+
+// event wait options
+#define EVENT_WAIT_ANY 0x00     // wake when any of the flags is set
+#define EVENT_WAIT_ALL 0x01     // wake when all of the flags are set
+#define EVENT_CLEAR    0x02     // clear the awaited flags when the wait is satisfied
+
+// wait queue order of a mutex or semaphore
+#define WAIT_FIFO     0
+#define WAIT_PRIORITY 1
 
 // tasks
 #define MAX_TASKS 12
 
+// scheduling policies
+#define SCHED_RR   0
+#define SCHED_PRIO 1
+#define SCHED_EDF  2
+
 //-----------------------------------------------------------------------------
 // Subroutines
 //-----------------------------------------------------------------------------
 
-bool initMutex(uint8_t mutex);
-bool initSemaphore(uint8_t semaphore, uint8_t count);
+// kernel objects are created and deleted with service calls, before startRtos or from
+// threads while it runs, but not from interrupt handlers
+mutexHandle createMutex(void);
+mutexHandle createMutexCeiling(uint8_t ceiling);
+bool deleteMutex(mutexHandle mutex);
+bool initFastMutex(fastMutex *fast);
+bool deleteFastMutex(fastMutex *fast);
+condHandle createCondition(void);
+bool deleteCondition(condHandle cv);
+rwlockHandle createRwLock(void);
+bool deleteRwLock(rwlockHandle lock);
+semaphoreHandle createSemaphore(uint8_t count);
+bool deleteSemaphore(semaphoreHandle semaphore);
+bool setMutexQueueOrder(mutexHandle mutex, uint8_t order);
+bool setSemaphoreQueueOrder(semaphoreHandle semaphore, uint8_t order);
+eventHandle createEventGroup(void);
+bool deleteEventGroup(eventHandle group);
+queueHandle createQueue(void *storage, uint16_t itemSize, uint8_t depth);
+queueHandle createPointerQueue(void **storage, uint8_t depth);
+bool deleteQueue(queueHandle queue);
+ringBuffer* createRing(uint32_t capacity, threadHandle consumer);
+bool deleteRing(ringBuffer *ring);
 
 void initRtos(void);
 void startRtos(void);
 
-bool createThread(_fn fn, const char name[], uint8_t priority, uint32_t stackBytes);
-void restartThread(_fn fn);
-void stopThread(_fn fn);
-void setThreadPriority(_fn fn, uint8_t priority);
+threadHandle createThread(_fn fn, const char name[], uint8_t priority, uint32_t stackBytes);
+threadHandle createPeriodicThread(_fn fn, const char name[], uint8_t priority, uint32_t period, uint32_t deadline, uint32_t wcet, uint32_t stackBytes);
+void restartThread(threadHandle thread);
+void stopThread(threadHandle thread);
+void setThreadPriority(threadHandle thread, uint8_t priority);
+void setTimeSlice(uint8_t priority, uint8_t ticks);
 
 void yield(void);
 void sleep(uint32_t tick);
-void lock(int8_t mutex);
-void unlock(int8_t mutex);
-void wait(int8_t semaphore);
-void post(int8_t semaphore);
+void sleepUntil(uint32_t tick);
+uint32_t getTicks(void);
+void waitPeriod(void);
+void lock(mutexHandle mutex);
+bool lockTimeout(mutexHandle mutex, uint32_t ticks);
+void unlock(mutexHandle mutex);
+void fastLock(fastMutex *fast);
+void fastUnlock(fastMutex *fast);
+bool condWait(condHandle cv, mutexHandle mutex);
+void condSignal(condHandle cv);
+void condBroadcast(condHandle cv);
+void readLock(rwlockHandle lock);
+void readUnlock(rwlockHandle lock);
+void writeLock(rwlockHandle lock);
+void writeUnlock(rwlockHandle lock);
+void wait(semaphoreHandle semaphore);
+bool waitTimeout(semaphoreHandle semaphore, uint32_t ticks);
+uint32_t setEvents(eventHandle group, uint32_t flags);
+uint32_t clearEvents(eventHandle group, uint32_t flags);
+uint32_t waitEvents(eventHandle group, uint32_t flags, uint8_t options, uint32_t ticks);
+// only from interrupt handlers at the kernel exception priority (the default, 0)
+void setEventsFromIsr(eventHandle group, uint32_t flags);
+bool postFromIsr(semaphoreHandle semaphore);
+bool ringPush(ringBuffer *ring, uint32_t item);
+uint32_t ringPop(ringBuffer *ring, uint32_t *items, uint32_t max);
+uint32_t ringWait(ringBuffer *ring, uint32_t *items, uint32_t max, uint32_t ticks);
+bool sendMessage(queueHandle queue, const void *msg, uint32_t ticks);
+bool receiveMessage(queueHandle queue, void *msg, uint32_t ticks);
+
+// synchronous client-server calls (sysregs.s), msg holds up to 4 words each way
+bool call(threadHandle server, uint32_t msg[4]);
+threadHandle replyWait(threadHandle client, uint32_t msg[4]);
+void post(semaphoreHandle semaphore);
 uint32_t _malloc_from_heap(uint32_t stackBytes);
 void reboot();
-void kill(uint32_t pid);
+void kill(threadHandle thread);
 void pkill(char *proc_name);
 void preempt(bool toggle);
+void pi(bool toggle);
+void tickless(bool toggle);
 //void schedule(bool prio_on);
-uint32_t pidof(char* name);
-uint32_t getPid();
+threadHandle pidof(char* name);
+threadHandle getPid();
+void benchmark(void);
+void rta(void);
 
 void systickIsr(void);
-void pendSvIsr(void);
-void svCallIsr(void);
+void wideTimer1Isr(void);
+uint32_t svCallHandler(uint32_t *frame, uint32_t start);
 
 #endif
@@ -127,6 +127,8 @@ void * mallocFromHeap(uint32_t size_in_bytes)
 {
     void* allocAdd;
     uint8_t number;
+    if(size_in_bytes > MAX_ALLOC_SIZE)
+        return (void*) NULL;
     procIndex++;
     if(size_in_bytes <= BLOCK_SIZE1)
     {
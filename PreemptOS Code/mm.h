@@ -12,6 +12,7 @@
 #define MM_H_
 
 #define NUM_SRAM_REGIONS 4
+#define MAX_ALLOC_SIZE   23552  // largest block mallocFromHeap can return (23 1 KiB subregions)
 
 //-----------------------------------------------------------------------------
 // Subroutines
@@ -59,26 +59,30 @@ int main(void)
     // Setup UART0 baud rate
     setUart0BaudRate(115200, 40e6);
 
-    // Initialize mutexes and semaphores
-    initMutex(resource);
-    initSemaphore(keyPressed, 1);
-    initSemaphore(keyReleased, 0);
-    initSemaphore(flashReq, 5);
+    // Create mutexes and semaphores
+    resource = createMutex();
+    keyPressed = createSemaphore(1);
+    keyReleased = createSemaphore(0);
+    flashReq = createSemaphore(5);
+    ok = (resource != INVALID_HANDLE) && (keyPressed != INVALID_HANDLE)
+      && (keyReleased != INVALID_HANDLE) && (flashReq != INVALID_HANDLE);
 
     // Add required idle process at lowest priority
-    ok =  createThread(idle, "Idle", 15, 512);
-//    ok &= createThread(idle2, "Idle2", 15, 512);
+    ok &= (createThread(idle, "Idle", 15, 512) != INVALID_HANDLE);
+//    ok &= (createThread(idle2, "Idle2", 15, 512) != INVALID_HANDLE);
 
     // Add other processes
-    ok &= createThread(lengthyFn, "LengthyFn", 12, 1024);
-    ok &= createThread(flash4Hz, "Flash4Hz", 8, 512);
-    ok &= createThread(oneshot, "OneShot", 4, 1536);
-    ok &= createThread(readKeys, "ReadKeys", 12, 1024);
-    ok &= createThread(debounce, "Debounce", 12, 1024);
-    ok &= createThread(important, "Important", 0, 1024);
-    ok &= createThread(uncooperative, "Uncoop", 12, 1024);
-    ok &= createThread(errant, "Errant", 12, 512);
-    ok &= createThread(shell, "Shell", 12, 4096);
+    lengthyFnThread = createThread(lengthyFn, "LengthyFn", 12, 1024);
+    ok &= (lengthyFnThread != INVALID_HANDLE);
+    flash4HzThread = createThread(flash4Hz, "Flash4Hz", 8, 512);
+    ok &= (flash4HzThread != INVALID_HANDLE);
+    ok &= (createThread(oneshot, "OneShot", 4, 1536) != INVALID_HANDLE);
+    ok &= (createThread(readKeys, "ReadKeys", 12, 1024) != INVALID_HANDLE);
+    ok &= (createThread(debounce, "Debounce", 12, 1024) != INVALID_HANDLE);
+    ok &= (createThread(important, "Important", 0, 1024) != INVALID_HANDLE);
+    ok &= (createThread(uncooperative, "Uncoop", 12, 1024) != INVALID_HANDLE);
+    ok &= (createThread(errant, "Errant", 12, 512) != INVALID_HANDLE);
+    ok &= (createThread(shell, "Shell", 12, 4096) != INVALID_HANDLE);
 
     // TODO: Add code to implement a periodic timer and ISR
 
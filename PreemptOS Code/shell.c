@@ -63,26 +63,26 @@ void shell(void)
 //            }
             else if(isCommand(&shellCommand, "kill", 1))
             {
-                uint32_t pid = getFieldInteger(&shellCommand, 1);
+                threadHandle pid = getFieldInteger(&shellCommand, 1);
                 kill(pid);
             }
             else if(isCommand(&shellCommand, "pkill", 1))
             {
                 char *proc_name = getFieldString(&shellCommand, 1);
-                uint32_t pid = pidof(proc_name);
+                threadHandle pid = pidof(proc_name);
                 kill(pid);
             }
-//            else if(isCommand(&shellCommand, "pi", 1))
-//            {
-//                const char* str1 = getFieldString(&shellCommand, 1);
-//                const char* str2 = "ON";
-//                const char* str3 = "OFF";
-//                if(stringCmp(str1, str2) == 0)
-//                    on = true;
-//                else if(stringCmp(str1, str3) == 0)
-//                    on = false;
-//                pi(on);
-//            }
+            else if(isCommand(&shellCommand, "pi", 1))
+            {
+                const char* str1 = getFieldString(&shellCommand, 1);
+                const char* str2 = "ON";
+                const char* str3 = "OFF";
+                if(stringCmp(str1, str2) == 0)
+                    on = true;
+                else if(stringCmp(str1, str3) == 0)
+                    on = false;
+                pi(on);
+            }
             else if(isCommand(&shellCommand, "preempt", 1))
             {
                 const char* str1 = getFieldString(&shellCommand, 1);
@@ -94,22 +94,55 @@ void shell(void)
                     on = false;
                 preempt(on);
             }
+            else if(isCommand(&shellCommand, "tickless", 1))
+            {
+                const char* str1 = getFieldString(&shellCommand, 1);
+                const char* str2 = "ON";
+                const char* str3 = "OFF";
+                if(stringCmp(str1, str2) == 0)
+                    on = true;
+                else if(stringCmp(str1, str3) == 0)
+                    on = false;
+                tickless(on);
+            }
             else if(isCommand(&shellCommand, "sched", 1))
             {
-                bool prio_on;
+                uint8_t policy;
                 const char* str1 = getFieldString(&shellCommand, 1);
                 const char* str2 = "PRIO";
                 const char* str3 = "RR";
+                const char* str4 = "EDF";
                 if(stringCmp(str1, str2) == 0)
-                    prio_on = true;
+                    policy = SCHED_PRIO;
                 else if(stringCmp(str1, str3) == 0)
-                    prio_on = false;
-                sched(prio_on);
+                    policy = SCHED_RR;
+                else if(stringCmp(str1, str4) == 0)
+                    policy = SCHED_EDF;
+                else
+                    policy = 0xFF;
+                if(policy == 0xFF)
+                    putsUart0("Usage: sched PRIO|RR|EDF\n");
+                else
+                    sched(policy);
+            }
+            else if(isCommand(&shellCommand, "rta", 0))
+            {
+                rta();
+            }
+            else if(isCommand(&shellCommand, "bench", 0))
+            {
+                benchmark();
+            }
+            else if(isCommand(&shellCommand, "slice", 2))
+            {
+                uint8_t priority = getFieldInteger(&shellCommand, 1);
+                uint8_t ticks = getFieldInteger(&shellCommand, 2);
+                setTimeSlice(priority, ticks);
             }
             else if(isCommand(&shellCommand, "pidof", 1))
             {
                 char* name = getFieldString(&shellCommand, 1);
-                uint32_t pid = pidof(name);
+                threadHandle pid = pidof(name);
                 char str[10];
                 if(pid != 0)
                 {
@@ -17,11 +17,11 @@ extern void setPsp(uint32_t address);               // Load and Set the PSP addr
 extern uint32_t getPsp();                           // get the address of PSP
 extern uint32_t getMsp();                           // get the address of MSP
 extern void switchToUnprivilegedMode();             // generate an MPU Fault
-extern uint8_t getSvcNo();                          // extract the Service Call Number
-extern void restoreTask();                          // restore the ne
-extern void saveContext();                          // save the context of the current task before switching
-extern uint32_t getR0();                            // get the function argument through R0
-extern void putR0(uint32_t value);                  // store the value of the pointer into R0
-extern void sched(bool prio_on);                    // Scheduler Priority Service Call
+extern void restoreTask();                          // restore the context of the task whose stack is in PSP
+extern void pendSvIsr(void);                        // switch tasks (saves and restores the context around taskSwitch())
+extern void svCallIsr(void);                        // pass the caller's exception frame to svCallHandler() and switch tasks if it asks to
+extern bool fastTryLock(volatile uint32_t *word, uint32_t owner);     // take a free fast mutex word (LDREX/STREX)
+extern bool fastTryUnlock(volatile uint32_t *word, uint32_t owner);   // free a fast mutex word that has no waiters
+extern void sched(uint8_t policy);                  // Scheduling Policy Service Call (SCHED_RR, SCHED_PRIO or SCHED_EDF)
 
 #endif
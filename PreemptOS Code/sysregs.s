@@ -21,17 +21,22 @@
 	.def getPsp
 	.def getMsp
 	.def switchToUnprivilegedMode
-	.def getSvcNo
 	.def restoreTask
-	.def saveContext
-	.def getR0
-	.def putR0
+	.def pendSvIsr
+	.def svCallIsr
 	.def sched
+	.def call
+	.def fastTryLock
+	.def fastTryUnlock
+	.def replyWait
 
 ;-----------------------------------------------------------------------------
 ; Register values and large immediate values
 ;-----------------------------------------------------------------------------
 
+	.ref taskSwitch
+	.ref svCallHandler
+
 .thumb
 .const
 
@@ -64,60 +69,115 @@ switchToUnprivilegedMode:
 	ISB					; Instruction Sync
 	BX	LR				; Return
 
-getSvcNo:
-	MRS R0, PSP         ; Load PSP into R0 to determine which function made the SV Call
-    LDR R0, [R0, #24]   ; Load return address of that function
-    LDRB R0, [R0, #-2]  ; Get the value of the argument from the location before the return address pointing to
-    BX  LR
-
 restoreTask:
 	MRS R0, PSP
-	LDR LR, [R0, #4]
-	LDR R4, [R0, #8]
-	LDR R5, [R0, #12]
-	LDR R6, [R0, #16]
-	LDR R7, [R0, #20]
-	LDR R8, [R0, #24]
-	LDR R9, [R0, #28]
-	LDR R10, [R0, #32]
-	LDR R11, [R0, #36]
-	ADD R0, #40
+	LDMIA R0!, {R4-R11, LR}	; R4-R11 and EXEC_RETURN
+	TST LR, #0x10		; EXEC_RETURN bit 4 clear means the task has an FPU context
+	IT EQ
+	VLDMIAEQ R0!, {S16-S31}	; restore the callee saved FPU registers
 	MSR PSP, R0
 	ISB
-	DSB
 	BX	LR
 
-saveContext:
-	MRS	R0, PSP
-	STR R11, [R0, #-4]
-	STR R10, [R0, #-8]
-	STR R9, [R0, #-12]
-	STR R8, [R0, #-16]
-	STR R7, [R0, #-20]
-	STR R6, [R0, #-24]
-	STR R5, [R0, #-28]
-	STR R4, [R0, #-32]
-	MOVW R1, #0xFFFD
-	MOVT R1, #0xFFFF
-    STR R1, [R0, #-36]
-	SUB R0, #40
+pendSvIsr:
+	MOVW R1, #0x1004
+	MOVT R1, #0xE000	; DWT cycle counter
+	LDR R1, [R1]		; cycle count on entry (second argument of taskSwitch)
+	MRS R0, PSP			; stack of the outgoing task
+	TST LR, #0x10		; EXEC_RETURN bit 4 clear means the task has an FPU context
+	IT EQ
+	VSTMDBEQ R0!, {S16-S31}	; save the callee saved FPU registers (this also completes the lazy save of S0-S15)
+	STMDB R0!, {R4-R11, LR}	; save R4-R11 and EXEC_RETURN
+	BL taskSwitch		; R0 = taskSwitch(R0, R1), the stack of the incoming task
+	LDMIA R0!, {R4-R11, LR}	; restore R4-R11 and EXEC_RETURN
+	TST LR, #0x10
+	IT EQ
+	VLDMIAEQ R0!, {S16-S31}
 	MSR PSP, R0
-	ISB
-	DSB
-	BX	LR
-
-getR0:
-	MRS R0, PSP
-	ISB
-	LDR R0, [R0]
-	BX	LR
-
-putR0:
-    MRS R1, PSP			; Get the current PSP value
-    ISB					; instruction sync barrier
-    STR R0, [R1]        ; Store the value of R0 at the address pointed to by PSP
-    DSB                 ; Data sync barrier
-    BX LR               ; Return from the function
+	BX	LR				; exception return into the incoming task
+
+svCallIsr:
+	MOVW R1, #0x1004
+	MOVT R1, #0xE000	; DWT cycle counter
+	LDR R1, [R1]		; cycle count on entry (second argument of svCallHandler)
+	TST LR, #4			; EXEC_RETURN bit 2 is clear for a call made on the main stack (before startRtos)
+	ITE EQ
+	MRSEQ R0, MSP		; exception frame of the caller (R0-R3, R12, LR, PC, xPSR)
+	MRSNE R0, PSP
+	PUSH {R4, LR}		; keep EXEC_RETURN (R4 keeps the stack 8 byte aligned)
+	BL svCallHandler	; R0 = 1 if the caller blocked or yielded
+	POP {R4, LR}
+	CMP R0, #0
+	IT EQ
+	BXEQ LR				; return to the caller
+	B pendSvIsr			; otherwise switch tasks now, without a second exception entry
 
 sched:
+	MOV R12, #0x0E		; service call number
 	SVC #0x0E
+	BX	LR
+
+; bool fastTryLock(volatile uint32_t *word, uint32_t owner)
+; stores owner in a free (0) word, returns false if the word is already owned
+fastTryLock:
+	LDREX R2, [R0]
+	CBNZ R2, fastTryLockBusy
+	STREX R2, R1, [R0]	; R2 = 0 if the word was still reserved
+	CMP R2, #0
+	BNE fastTryLock		; lost the reservation, try again
+	DMB					; the critical section starts after the store
+	MOV R0, #1
+	BX LR
+fastTryLockBusy:
+	CLREX
+	MOV R0, #0
+	BX LR
+
+; bool fastTryUnlock(volatile uint32_t *word, uint32_t owner)
+; clears a word that holds just owner, returns false if it also flags waiters
+fastTryUnlock:
+	DMB					; the critical section ends before the store
+fastTryUnlockRetry:
+	LDREX R2, [R0]
+	CMP R2, R1
+	BNE fastTryUnlockBusy
+	MOV R3, #0
+	STREX R2, R3, [R0]
+	CMP R2, #0
+	BNE fastTryUnlockRetry
+	MOV R0, #1
+	BX LR
+fastTryUnlockBusy:
+	CLREX
+	MOV R0, #0
+	BX LR
+
+; bool call(threadHandle server, uint32_t msg[4])
+; sends msg to the server and waits for the reply, which overwrites msg
+; returns false if the server does not exist or stopped before replying
+call:
+	PUSH {R4, LR}
+	MOV R4, R1			; msg (R4 is preserved across the service call)
+	LSL R12, R0, #8		; server handle above the service call number
+	ORR R12, R12, #0x1F	; CALL
+	LDMIA R4, {R0-R3}	; request
+	SVC #0x1F
+	STMIA R4, {R0-R3}	; reply
+	LSRS R0, R12, #8	; server handle, or 0 if the call failed
+	IT NE
+	MOVNE R0, #1
+	POP {R4, PC}
+
+; threadHandle replyWait(threadHandle client, uint32_t msg[4])
+; replies msg to client (INVALID_HANDLE for none), then waits for the next request,
+; which overwrites msg, and returns the handle of the client that made it
+replyWait:
+	PUSH {R4, LR}
+	MOV R4, R1			; msg (R4 is preserved across the service call)
+	LSL R12, R0, #8		; client handle above the service call number
+	ORR R12, R12, #0x20	; REPLY_WAIT
+	LDMIA R4, {R0-R3}	; reply
+	SVC #0x20
+	STMIA R4, {R0-R3}	; request
+	LSR R0, R12, #8		; client handle
+	POP {R4, PC}
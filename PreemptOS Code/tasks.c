@@ -34,6 +34,17 @@
 #define PB_EXT5    PORTD,6 // off-board PB5
 #define PB_EXT6    PORTD,7 // off-board PB6
 
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+mutexHandle resource;
+semaphoreHandle keyPressed;
+semaphoreHandle keyReleased;
+semaphoreHandle flashReq;
+threadHandle flash4HzThread;
+threadHandle lengthyFnThread;
+
 //-----------------------------------------------------------------------------
 // Subroutines
 //-----------------------------------------------------------------------------
@@ -97,6 +108,16 @@ void initTimer(void)
     WTIMER0_CTL_R &= ~TIMER_CTL_TAEN;
     WTIMER0_CFG_R = TIMER_CFG_32_BIT_TIMER;
     WTIMER0_TAMR_R |= TIMER_TAMR_TACDIR;
+
+    // Wide timer 1 wakes the kernel from tickless idle
+    SYSCTL_RCGCWTIMER_R |= SYSCTL_RCGCWTIMER_R1;
+    _delay_cycles(3);
+
+    WTIMER1_CTL_R &= ~TIMER_CTL_TAEN;
+    WTIMER1_CFG_R = TIMER_CFG_32_BIT_TIMER;
+    WTIMER1_TAMR_R = TIMER_TAMR_TAMR_1_SHOT | TIMER_TAMR_TACDIR;
+    WTIMER1_IMR_R = TIMER_IMR_TATOIM;
+    NVIC_EN3_R = 1 << (INT_WTIMER1A-16-96);
 }
 
 // Read Push Buttons and return a value from 0-63 indicating which of 6 PBs are pressed
@@ -125,7 +146,7 @@ void idle(void)
     while(true)
     {
         setPinValue(ORANGE_LED, 1);
-        waitMicrosecond(1000);
+        __asm(" WFI");                      // sleep until the next tick or tickless wakeup
         setPinValue(ORANGE_LED, 0);
         yield();
     }
@@ -143,10 +164,12 @@ void idle2(void)
 
 void flash4Hz(void)
 {
+    uint32_t next = getTicks();
     while(true)
     {
         setPinValue(GREEN_LED, !getPinValue(GREEN_LED));
-        sleep(125);
+        next += 125;
+        sleepUntil(next);
     }
 }
 
@@ -212,15 +235,15 @@ void readKeys(void)
         }
         if ((buttons & 4) != 0)
         {
-            restartThread(flash4Hz);
+            restartThread(flash4HzThread);
         }
         if ((buttons & 8) != 0)
         {
-            stopThread(flash4Hz);
+            stopThread(flash4HzThread);
         }
         if ((buttons & 16) != 0)
         {
-            setThreadPriority(lengthyFn, 4);
+            setThreadPriority(lengthyFnThread, 4);
         }
         yield();
     }
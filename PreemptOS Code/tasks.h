@@ -11,6 +11,17 @@
 #ifndef TASKS_H_
 #define TASKS_H_
 
+//-----------------------------------------------------------------------------
+// Kernel objects shared by the tasks
+//-----------------------------------------------------------------------------
+
+extern mutexHandle resource;
+extern semaphoreHandle keyPressed;
+extern semaphoreHandle keyReleased;
+extern semaphoreHandle flashReq;
+extern threadHandle flash4HzThread;
+extern threadHandle lengthyFnThread;
+
 //-----------------------------------------------------------------------------
 // Subroutines
 //-----------------------------------------------------------------------------